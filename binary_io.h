@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace binary_io {
+
+template <typename T>
+void WriteValue(std::ostream& out, T value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T ReadValue(std::istream& in) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    T value{};
+    if (!in.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+        throw std::runtime_error("Unexpected end of binary data");
+    }
+    return value;
+}
+
+inline void WriteString(std::ostream& out, std::string_view str) {
+    WriteValue<uint32_t>(out, static_cast<uint32_t>(str.size()));
+    out.write(str.data(), static_cast<std::streamsize>(str.size()));
+}
+
+inline std::string ReadString(std::istream& in) {
+    std::string str(ReadValue<uint32_t>(in), '\0');
+    if (!in.read(str.data(), static_cast<std::streamsize>(str.size()))) {
+        throw std::runtime_error("Unexpected end of binary data");
+    }
+    return str;
+}
+
+template <typename T>
+void WriteVector(std::ostream& out, const std::vector<T>& values) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    WriteValue<uint64_t>(out, values.size());
+    out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+template <typename T>
+std::vector<T> ReadVector(std::istream& in) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    std::vector<T> values(ReadValue<uint64_t>(in));
+    if (!in.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)))) {
+        throw std::runtime_error("Unexpected end of binary data");
+    }
+    return values;
+}
+
+}
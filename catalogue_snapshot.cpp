@@ -0,0 +1,252 @@
+#include "catalogue_snapshot.h"
+#include <fstream>
+#include <iostream>
+#include <unordered_set>
+
+#include "json_reader.h"
+
+using namespace std;
+
+CatalogueSnapshot::CatalogueSnapshot(const json::Document& base_doc, uint64_t version)
+    : version_(version)
+    , transport_c_(JsonReader().ReadCoordinatesEncodingJson(base_doc)) {
+    RequestHander base_handler;
+    JsonReader reader;
+    reader.ReadBaseJsonRequests(base_doc, base_handler);
+    base_handler.ProvideInputRequests(transport_c_);
+
+    const json::Dict& base_root = base_doc.GetRoot().AsMap();
+    if (auto settings_it = base_root.find("render_settings"s); settings_it != base_root.end()) {
+        render_settings_ = settings_it->second;
+    }
+    if (auto settings_it = base_root.find("routing_settings"s); settings_it != base_root.end()) {
+        routing_settings_ = settings_it->second;
+    }
+    if (auto schedules_it = base_root.find("schedules"s); schedules_it != base_root.end()) {
+        schedules_ = schedules_it->second;
+    }
+    BuildCaches();
+}
+
+CatalogueSnapshot::CatalogueSnapshot(TransportCatalogue transport_c, json::Node render_settings,
+    json::Node routing_settings, json::Node schedules, uint64_t version)
+    : version_(version)
+    , transport_c_(move(transport_c))
+    , render_settings_(move(render_settings))
+    , routing_settings_(move(routing_settings))
+    , schedules_(move(schedules)) {
+    BuildCaches();
+}
+
+void CatalogueSnapshot::BuildCaches() {
+    if (!render_settings_.IsNull()) {
+        route_map_.emplace();
+        JsonReader().ReadRenderSettingsJson(json::Document(json::Dict{{"render_settings"s, render_settings_}}), *route_map_);
+        for (auto& bus_ptr : transport_c_.GetAllBuses()) {
+            route_map_->AddRoute(bus_ptr);
+        }
+        route_map_->ReorderRouteColors();
+        route_map_->UpdateLayout();
+    }
+
+    fragments_ = StatFragments(transport_c_);
+    handler_.SetStatFragments(&fragments_);
+    stops_index_ = StopsIndex(transport_c_.GetAllStops());
+    handler_.SetStopsIndex(&stops_index_);
+    segments_index_ = SegmentsIndex(transport_c_.GetAllBuses());
+    handler_.SetSegmentsIndex(&segments_index_);
+    BuildRouter();
+}
+
+void CatalogueSnapshot::Refresh() {
+    if (!router_stale_) {
+        return;
+    }
+    router_stale_ = false;
+    BuildRouter();
+    if (rebuild_hierarchy_ && router_) {
+        router_->BuildHierarchy();
+    }
+    rebuild_hierarchy_ = false;
+}
+
+void CatalogueSnapshot::BuildRouter() {
+    if (routing_settings_.IsNull()) {
+        return;
+    }
+    JsonReader reader;
+    RoutingSettings settings = reader.ReadRoutingSettingsJson(
+        json::Document(json::Dict{{"routing_settings"s, routing_settings_}}));
+    if (settings.landmarks_count_ > 0) {
+        router_.emplace(transport_c_, settings, ThreadPool::GetShared());
+    } else {
+        router_.emplace(transport_c_, settings);
+    }
+    handler_.SetRouter(&*router_);
+    if (!schedules_.IsNull()) {
+        timetable_.emplace(transport_c_, settings, reader.ReadSchedulesJson(schedules_));
+        handler_.SetTimetable(&*timetable_);
+    }
+}
+
+void CatalogueSnapshot::InvalidateRouter() {
+    if (router_stale_) {
+        return;
+    }
+    rebuild_hierarchy_ = router_ && router_->HasHierarchy();
+    handler_.SetRouter(nullptr);
+    handler_.SetTimetable(nullptr);
+    router_.reset();
+    timetable_.reset();
+    router_stale_ = true;
+}
+
+void CatalogueSnapshot::RemoveBus(string_view bus) {
+    const Bus* bus_ptr = transport_c_.FindBus(bus);
+    if (bus_ptr == nullptr) {
+        throw invalid_argument("Attempt to remove unknown bus: "s + string(bus));
+    }
+
+    const string name = bus_ptr->name_;
+    const vector<Stop*> old_route = bus_ptr->route_;
+    if (route_map_) {
+        route_map_->RemoveRoute(bus_ptr);
+        route_map_->ReorderRouteColors();
+        route_map_->UpdateLayout();
+    }
+    segments_index_.RemoveBus(bus_ptr);
+    transport_c_.RemoveBus(name);
+
+    fragments_.UpdateBus(transport_c_, name);
+    RefreshStopFragments(old_route);
+    InvalidateRouter();
+}
+
+void CatalogueSnapshot::UpdateBusRoute(string_view bus, const vector<string_view>& route, bool is_round) {
+    const Bus* bus_ptr = transport_c_.FindBus(bus);
+    if (bus_ptr == nullptr) {
+        throw invalid_argument("Attempt to update unknown bus: "s + string(bus));
+    }
+
+    const vector<Stop*> old_route = bus_ptr->route_;
+    if (route_map_) {
+        route_map_->RemoveRoute(bus_ptr);
+    }
+    try {
+        transport_c_.UpdateBusRoute(bus_ptr->name_, route, is_round);
+    } catch (...) {
+        if (route_map_) {
+            route_map_->AddRoute(bus_ptr);
+            route_map_->ReorderRouteColors();
+            route_map_->UpdateLayout();
+        }
+        throw;
+    }
+    if (route_map_) {
+        route_map_->AddRoute(bus_ptr);
+        route_map_->ReorderRouteColors();
+        route_map_->UpdateLayout();
+    }
+
+    fragments_.UpdateBus(transport_c_, bus_ptr->name_);
+    RefreshStopFragments(old_route);
+    RefreshStopFragments(bus_ptr->route_);
+    segments_index_.UpdateBus(bus_ptr);
+    InvalidateRouter();
+}
+
+void CatalogueSnapshot::MoveStop(string_view stop, Geo::Coordinates coordinates) {
+    transport_c_.MoveStop(stop, coordinates);
+    RefreshBusFragments(stop);
+    stops_index_.MoveStop(transport_c_.FindStop(stop));
+    if (route_map_) {
+        route_map_->MoveStop(transport_c_.FindStop(stop));
+    }
+    if (const BusPtrsSet* buses = transport_c_.FindBuses(stop)) {
+        for (const Bus* bus : *buses) {
+            segments_index_.UpdateBus(bus);
+        }
+    }
+    if (router_ && router_->HasLandmarks()) {
+        InvalidateRouter();
+    }
+}
+
+void CatalogueSnapshot::UpdateDistance(string_view stop_from, string_view stop_to, uint32_t distance) {
+    transport_c_.UpdateDistance(stop_from, stop_to, distance);
+    RefreshBusFragments(stop_from);
+    InvalidateRouter();
+}
+
+void CatalogueSnapshot::RefreshStopFragments(const vector<Stop*>& stops) {
+    unordered_set<const Stop*> refreshed;
+    for (const Stop* stop : stops) {
+        if (refreshed.insert(stop).second) {
+            fragments_.UpdateStop(transport_c_, stop->name_);
+        }
+    }
+}
+
+void CatalogueSnapshot::RefreshBusFragments(string_view stop) {
+    const BusPtrsSet* buses = transport_c_.FindBuses(stop);
+    if (buses == nullptr) {
+        return;
+    }
+    for (const Bus* bus : *buses) {
+        fragments_.UpdateBus(transport_c_, bus->name_);
+    }
+}
+
+SnapshotHolder::~SnapshotHolder() {
+    lock_guard lock(reload_mutex_);
+    if (reload_thread_.joinable()) {
+        reload_thread_.join();
+    }
+}
+
+shared_ptr<const CatalogueSnapshot> SnapshotHolder::Load() const {
+    return current_.load();
+}
+
+void SnapshotHolder::Publish(shared_ptr<CatalogueSnapshot> snapshot) {
+    snapshot->Refresh();
+    if (route_cache_ != nullptr) {
+        snapshot->handler_.SetRouteCache(route_cache_, snapshot->version_);
+    }
+    current_.store(move(snapshot));
+}
+
+void SnapshotHolder::SetRouteCache(RouteCache* route_cache) {
+    route_cache_ = route_cache;
+}
+
+uint64_t SnapshotHolder::Reload(istream& base_input) {
+    json::Document base_doc = json::Load(base_input);
+    const uint64_t version = next_version_++;
+    Publish(make_shared<CatalogueSnapshot>(base_doc, version));
+    return version;
+}
+
+void SnapshotHolder::ReloadAsync(const string& base_path) {
+    ReloadAsync([base_path](uint64_t version) {
+        ifstream base_input(base_path);
+        if (!base_input) {
+            throw runtime_error("Cannot open base requests file: "s + base_path);
+        }
+        return make_unique<CatalogueSnapshot>(json::Load(base_input), version);
+    });
+}
+
+void SnapshotHolder::ReloadAsync(function<unique_ptr<CatalogueSnapshot>(uint64_t version)> load) {
+    lock_guard lock(reload_mutex_);
+    if (reload_thread_.joinable()) {
+        reload_thread_.join();
+    }
+    reload_thread_ = thread([this, load = move(load)] {
+        try {
+            Publish(load(next_version_++));
+        } catch (const exception& e) {
+            cerr << "Reload is failed, the previous catalogue is kept: "s << e.what() << endl;
+        }
+    });
+}
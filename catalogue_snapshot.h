@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "json.h"
+#include "request_handler.h"
+#include "stat_fragments.h"
+
+struct CatalogueSnapshot {
+    explicit CatalogueSnapshot(const json::Document& base_doc, uint64_t version = 0);
+    CatalogueSnapshot(TransportCatalogue transport_c, json::Node render_settings, json::Node routing_settings,
+        json::Node schedules, uint64_t version = 0);
+    CatalogueSnapshot(const CatalogueSnapshot&) = delete;
+    CatalogueSnapshot& operator=(const CatalogueSnapshot&) = delete;
+
+    void RemoveBus(std::string_view bus);
+    void UpdateBusRoute(std::string_view bus, const std::vector<std::string_view>& route, bool is_round = false);
+    void MoveStop(std::string_view stop, Geo::Coordinates coordinates);
+    void UpdateDistance(std::string_view stop_from, std::string_view stop_to, uint32_t distance);
+    void Refresh();
+
+    uint64_t version_ = 0;
+    TransportCatalogue transport_c_;
+    json::Node render_settings_;
+    json::Node routing_settings_;
+    json::Node schedules_;
+    std::optional<map_renderer::MapRenderer> route_map_;
+    std::optional<TransportRouter> router_;
+    std::optional<Timetable> timetable_;
+    StatFragments fragments_;
+    StopsIndex stops_index_;
+    SegmentsIndex segments_index_;
+    RequestHander handler_;
+
+private:
+    void BuildCaches();
+    void BuildRouter();
+    void InvalidateRouter();
+    void RefreshStopFragments(const std::vector<Stop*>& stops);
+    void RefreshBusFragments(std::string_view stop);
+
+    bool router_stale_ = false;
+    bool rebuild_hierarchy_ = false;
+};
+
+class SnapshotHolder {
+public:
+    SnapshotHolder() = default;
+    SnapshotHolder(const SnapshotHolder&) = delete;
+    SnapshotHolder& operator=(const SnapshotHolder&) = delete;
+    ~SnapshotHolder();
+
+    std::shared_ptr<const CatalogueSnapshot> Load() const;
+    void Publish(std::shared_ptr<CatalogueSnapshot> snapshot);
+    void SetRouteCache(RouteCache* route_cache);
+    uint64_t Reload(std::istream& base_input);
+    void ReloadAsync(const std::string& base_path);
+    void ReloadAsync(std::function<std::unique_ptr<CatalogueSnapshot>(uint64_t version)> load);
+
+private:
+    std::atomic<std::shared_ptr<const CatalogueSnapshot>> current_;
+    RouteCache* route_cache_ = nullptr;
+    std::atomic<uint64_t> next_version_ = 1;
+    std::mutex reload_mutex_;
+    std::thread reload_thread_;
+};
@@ -0,0 +1,502 @@
+#include "catalogue_store.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+#include "binary_io.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace binary_io;
+
+namespace {
+
+const uint32_t CHECKPOINT_MAGIC = 0x50434354;
+const uint32_t CHECKPOINT_FORMAT = 4;
+const uint32_t MAX_RECORD_SIZE = 64u << 20;
+
+void WriteSettings(ostream& out, const json::Node& settings) {
+    string settings_str;
+    if (!settings.IsNull()) {
+        ostringstream settings_stream;
+        json::PrintNode(json::Document(settings), settings_stream);
+        settings_str = settings_stream.str();
+    }
+    WriteString(out, settings_str);
+}
+
+json::Node ReadSettings(istream& in) {
+    string settings_str = ReadString(in);
+    if (settings_str.empty()) {
+        return {};
+    }
+    istringstream settings_stream(settings_str);
+    return json::Load(settings_stream).GetRoot();
+}
+
+uint32_t ComputeChecksum(string_view data) {
+    uint32_t hash = 2166136261u;
+    for (char ch : data) {
+        hash = (hash ^ static_cast<uint8_t>(ch)) * 16777619u;
+    }
+    return hash;
+}
+
+void WriteChangePayload(const LoggedChange& logged, ostream& out) {
+    const CatalogueChange& change = logged.change_;
+    WriteValue<uint64_t>(out, logged.sequence_);
+    WriteValue<uint8_t>(out, static_cast<uint8_t>(change.type_));
+    WriteString(out, change.name_);
+
+    switch (change.type_) {
+    case ChangeType::RemoveBus:
+        break;
+    case ChangeType::UpdateBusRoute:
+        WriteValue<uint8_t>(out, change.is_round_);
+        WriteValue<uint32_t>(out, static_cast<uint32_t>(change.route_.size()));
+        for (const string& stop : change.route_) {
+            WriteString(out, stop);
+        }
+        break;
+    case ChangeType::MoveStop:
+        WriteValue<double>(out, change.coords_.lat);
+        WriteValue<double>(out, change.coords_.lng);
+        break;
+    case ChangeType::UpdateDistance:
+        WriteString(out, change.other_name_);
+        WriteValue<uint32_t>(out, change.distance_);
+        break;
+    }
+}
+
+LoggedChange ReadChangePayload(istream& in) {
+    LoggedChange logged;
+    CatalogueChange& change = logged.change_;
+    logged.sequence_ = ReadValue<uint64_t>(in);
+    change.type_ = static_cast<ChangeType>(ReadValue<uint8_t>(in));
+    change.name_ = ReadString(in);
+
+    switch (change.type_) {
+    case ChangeType::RemoveBus:
+        break;
+    case ChangeType::UpdateBusRoute: {
+        change.is_round_ = ReadValue<uint8_t>(in) != 0;
+        uint32_t count = ReadValue<uint32_t>(in);
+        for (uint32_t i = 0; i < count; ++i) {
+            change.route_.push_back(ReadString(in));
+        }
+        break;
+    }
+    case ChangeType::MoveStop:
+        change.coords_.lat = ReadValue<double>(in);
+        change.coords_.lng = ReadValue<double>(in);
+        break;
+    case ChangeType::UpdateDistance:
+        change.other_name_ = ReadString(in);
+        change.distance_ = ReadValue<uint32_t>(in);
+        break;
+    default:
+        throw runtime_error("Unknown change type in the log"s);
+    }
+    return logged;
+}
+
+bool SyncFile(FILE* file) {
+    if (fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+void SyncFile(const string& path) {
+    FILE* file = fopen(path.c_str(), "ab");
+    const bool is_synced = file != nullptr && SyncFile(file);
+    if (file != nullptr) {
+        fclose(file);
+    }
+    if (!is_synced) {
+        throw runtime_error("Cannot sync file: "s + path);
+    }
+}
+
+void ValidateStop(const TransportCatalogue& transport_c, string_view stop) {
+    if (transport_c.FindStop(stop) == nullptr) {
+        throw invalid_argument("Unknown stop: "s + string(stop) + '\n');
+    }
+}
+
+void ValidateBus(const TransportCatalogue& transport_c, string_view bus) {
+    if (transport_c.FindBus(bus) == nullptr) {
+        throw invalid_argument("Unknown bus: "s + string(bus) + '\n');
+    }
+}
+
+}
+
+void ValidateChange(const CatalogueSnapshot& snapshot, const CatalogueChange& change) {
+    const TransportCatalogue& transport_c = snapshot.transport_c_;
+    switch (change.type_) {
+    case ChangeType::RemoveBus:
+        ValidateBus(transport_c, change.name_);
+        break;
+    case ChangeType::UpdateBusRoute:
+        ValidateBus(transport_c, change.name_);
+        if (change.route_.empty()) {
+            throw invalid_argument("Empty route for bus: "s + change.name_ + '\n');
+        }
+        for (const string& stop : change.route_) {
+            ValidateStop(transport_c, stop);
+        }
+        break;
+    case ChangeType::MoveStop:
+        ValidateStop(transport_c, change.name_);
+        if (!transport_c.GetStopsCoordinates().CanStore(change.coords_)) {
+            throw invalid_argument("Coordinates can't be stored for stop: "s + change.name_ + '\n');
+        }
+        break;
+    case ChangeType::UpdateDistance:
+        ValidateStop(transport_c, change.name_);
+        ValidateStop(transport_c, change.other_name_);
+        break;
+    default:
+        throw invalid_argument("Unknown change type"s);
+    }
+}
+
+void ApplyChange(CatalogueSnapshot& snapshot, const CatalogueChange& change) {
+    switch (change.type_) {
+    case ChangeType::RemoveBus:
+        snapshot.RemoveBus(change.name_);
+        break;
+    case ChangeType::UpdateBusRoute:
+        snapshot.UpdateBusRoute(change.name_, vector<string_view>(change.route_.begin(), change.route_.end()),
+            change.is_round_);
+        break;
+    case ChangeType::MoveStop:
+        snapshot.MoveStop(change.name_, change.coords_);
+        break;
+    case ChangeType::UpdateDistance:
+        snapshot.UpdateDistance(change.name_, change.other_name_, change.distance_);
+        break;
+    }
+}
+
+void WriteLoggedChange(const LoggedChange& logged, ostream& out) {
+    ostringstream payload_stream;
+    WriteChangePayload(logged, payload_stream);
+    const string payload = payload_stream.str();
+
+    WriteValue<uint32_t>(out, static_cast<uint32_t>(payload.size()));
+    WriteValue<uint32_t>(out, ComputeChecksum(payload));
+    out.write(payload.data(), static_cast<streamsize>(payload.size()));
+}
+
+vector<LoggedChange> ReadLoggedChanges(istream& in) {
+    vector<LoggedChange> changes;
+    while (in.peek() != char_traits<char>::eof()) {
+        const streampos record_start = in.tellg();
+        try {
+            uint32_t size = ReadValue<uint32_t>(in);
+            uint32_t checksum = ReadValue<uint32_t>(in);
+            if (size > MAX_RECORD_SIZE) {
+                throw runtime_error("Log record is too large"s);
+            }
+            string payload(size, '\0');
+            if (!in.read(payload.data(), size) || ComputeChecksum(payload) != checksum) {
+                throw runtime_error("Log record is torn"s);
+            }
+            istringstream payload_stream(payload);
+            changes.push_back(ReadChangePayload(payload_stream));
+        } catch (const runtime_error&) {
+            in.clear();
+            in.seekg(record_start);
+            break;
+        }
+    }
+    return changes;
+}
+
+void SaveCheckpoint(const CatalogueSnapshot& snapshot, uint64_t sequence, ostream& out) {
+    const TransportCatalogue& transport_c = snapshot.transport_c_;
+    WriteValue<uint32_t>(out, CHECKPOINT_MAGIC);
+    WriteValue<uint32_t>(out, CHECKPOINT_FORMAT);
+    WriteValue<uint64_t>(out, sequence);
+
+    WriteSettings(out, snapshot.render_settings_);
+    WriteSettings(out, snapshot.routing_settings_);
+    WriteSettings(out, snapshot.schedules_);
+    const Geo::CoordinatesEncoding encoding = transport_c.GetStopsCoordinates().GetEncoding();
+    WriteValue<uint8_t>(out, static_cast<uint8_t>(encoding));
+
+    vector<const Stop*> stops = transport_c.GetAllStops();
+    unordered_map<const Stop*, uint32_t> stops_indexes;
+    WriteValue<uint32_t>(out, static_cast<uint32_t>(stops.size()));
+    for (const Stop* stop : stops) {
+        stops_indexes[stop] = static_cast<uint32_t>(stops_indexes.size());
+        WriteString(out, stop->name_);
+        const Geo::Coordinates coords = stop->GetCoordinates();
+        if (encoding == Geo::CoordinatesEncoding::FixedPoint) {
+            WriteValue<int32_t>(out, static_cast<int32_t>(lround(coords.lat * Geo::CoordinatesArray::FIXED_POINT_UNITS)));
+            WriteValue<int32_t>(out, static_cast<int32_t>(lround(coords.lng * Geo::CoordinatesArray::FIXED_POINT_UNITS)));
+        } else {
+            WriteValue<double>(out, coords.lat);
+            WriteValue<double>(out, coords.lng);
+        }
+    }
+
+    size_t distances_count = 0;
+    for (const Stop* stop : stops) {
+        distances_count += stop->neighbor_stops_dist_.size() - stop->implied_neighbors_.size();
+    }
+    WriteValue<uint32_t>(out, static_cast<uint32_t>(distances_count));
+    for (const Stop* stop : stops) {
+        for (const auto& [neighbor, distance] : stop->neighbor_stops_dist_) {
+            if (stop->implied_neighbors_.contains(neighbor)) {
+                continue;
+            }
+            WriteValue<uint32_t>(out, stops_indexes.at(stop));
+            WriteValue<uint32_t>(out, stops_indexes.at(neighbor));
+            WriteValue<uint32_t>(out, distance);
+        }
+    }
+
+    // AddBus prepends to the bus list, so buses are written oldest first to restore the same order on load.
+    vector<const Bus*> buses = transport_c.GetAllBuses();
+    reverse(buses.begin(), buses.end());
+    WriteValue<uint32_t>(out, static_cast<uint32_t>(buses.size()));
+    for (const Bus* bus : buses) {
+        WriteString(out, bus->name_);
+        WriteValue<uint8_t>(out, bus->is_round_);
+        WriteValue<uint32_t>(out, static_cast<uint32_t>(bus->route_.size()));
+        for (const Stop* stop : bus->route_) {
+            WriteValue<uint32_t>(out, stops_indexes.at(stop));
+        }
+    }
+}
+
+Checkpoint LoadCheckpoint(istream& in, uint64_t version) {
+    if (ReadValue<uint32_t>(in) != CHECKPOINT_MAGIC) {
+        throw runtime_error("Unsupported catalogue checkpoint format"s);
+    }
+    const uint32_t format = ReadValue<uint32_t>(in);
+    if (format != CHECKPOINT_FORMAT) {
+        throw runtime_error("Unsupported catalogue checkpoint format"s);
+    }
+    Checkpoint checkpoint;
+    checkpoint.sequence_ = ReadValue<uint64_t>(in);
+
+    json::Node render_settings = ReadSettings(in);
+    json::Node routing_settings = ReadSettings(in);
+    json::Node schedules = ReadSettings(in);
+    const auto encoding = static_cast<Geo::CoordinatesEncoding>(ReadValue<uint8_t>(in));
+    if (encoding != Geo::CoordinatesEncoding::Double && encoding != Geo::CoordinatesEncoding::FixedPoint) {
+        throw runtime_error("Unsupported catalogue checkpoint format"s);
+    }
+
+    TransportCatalogue transport_c(encoding);
+    vector<string> stops_names(ReadValue<uint32_t>(in));
+    for (string& name : stops_names) {
+        name = ReadString(in);
+        Geo::Coordinates coords;
+        if (encoding == Geo::CoordinatesEncoding::FixedPoint) {
+            coords.lat = ReadValue<int32_t>(in) / Geo::CoordinatesArray::FIXED_POINT_UNITS;
+            coords.lng = ReadValue<int32_t>(in) / Geo::CoordinatesArray::FIXED_POINT_UNITS;
+        } else {
+            coords.lat = ReadValue<double>(in);
+            coords.lng = ReadValue<double>(in);
+        }
+        transport_c.AddStop(name, coords);
+    }
+
+    const uint32_t distances_count = ReadValue<uint32_t>(in);
+    for (uint32_t i = 0; i < distances_count; ++i) {
+        uint32_t from = ReadValue<uint32_t>(in);
+        uint32_t to = ReadValue<uint32_t>(in);
+        uint32_t distance = ReadValue<uint32_t>(in);
+        transport_c.UpdateDistance(stops_names.at(from), stops_names.at(to), distance);
+    }
+
+    const uint32_t buses_count = ReadValue<uint32_t>(in);
+    for (uint32_t i = 0; i < buses_count; ++i) {
+        string name = ReadString(in);
+        bool is_round = ReadValue<uint8_t>(in) != 0;
+        vector<string_view> route(ReadValue<uint32_t>(in));
+        for (string_view& stop : route) {
+            stop = stops_names.at(ReadValue<uint32_t>(in));
+        }
+        transport_c.AddBus(name, route, is_round);
+    }
+    transport_c.ReorderStopsAlongHilbertCurve();
+
+    checkpoint.snapshot_ = make_unique<CatalogueSnapshot>(move(transport_c), move(render_settings),
+        move(routing_settings), move(schedules), version);
+    return checkpoint;
+}
+
+CatalogueStore::CatalogueStore(const string& directory) {
+    filesystem::create_directories(directory);
+    checkpoint_path_ = (filesystem::path(directory) / "catalogue.checkpoint"s).string();
+    log_path_ = (filesystem::path(directory) / "catalogue.log"s).string();
+    hierarchy_path_ = (filesystem::path(directory) / "catalogue.hierarchy"s).string();
+}
+
+bool CatalogueStore::HasCheckpoint() const {
+    return filesystem::exists(checkpoint_path_);
+}
+
+CatalogueStore::~CatalogueStore() {
+    CloseLog();
+}
+
+unique_ptr<CatalogueSnapshot> CatalogueStore::Open(uint64_t version) {
+    Replayed replayed = Replay(version);
+    sequence_ = replayed.sequence_;
+    log_tail_size_ = replayed.log_tail_size_;
+    if (replayed.log_valid_size_ >= 0) {
+        filesystem::resize_file(log_path_, static_cast<uintmax_t>(replayed.log_valid_size_));
+    }
+
+    OpenLog(false);
+    return move(replayed.snapshot_);
+}
+
+unique_ptr<CatalogueSnapshot> CatalogueStore::Read(uint64_t version) const {
+    return Replay(version).snapshot_;
+}
+
+void CatalogueStore::Apply(CatalogueSnapshot& snapshot, const CatalogueChange& change) {
+    if (log_ == nullptr) {
+        throw logic_error("The catalogue store is not opened"s);
+    }
+    ValidateChange(snapshot, change);
+
+    ostringstream record_stream;
+    WriteLoggedChange({sequence_ + 1, change}, record_stream);
+    const string record = record_stream.str();
+    const uintmax_t log_size = filesystem::file_size(log_path_);
+    if (fwrite(record.data(), 1, record.size(), log_) != record.size() || !SyncFile(log_)) {
+        CloseLog();
+        error_code resize_error;
+        filesystem::resize_file(log_path_, log_size, resize_error);
+        OpenLog(false);
+        throw runtime_error("Cannot append to the catalogue log: "s + log_path_);
+    }
+    ++sequence_;
+    ++log_tail_size_;
+
+    ApplyChange(snapshot, change);
+}
+
+void CatalogueStore::MakeCheckpoint(const CatalogueSnapshot& snapshot) {
+    const string temporary_path = checkpoint_path_ + ".tmp"s;
+    {
+        ofstream checkpoint_output(temporary_path, ios::binary | ios::trunc);
+        SaveCheckpoint(snapshot, sequence_, checkpoint_output);
+        checkpoint_output.flush();
+        if (!checkpoint_output) {
+            throw runtime_error("Cannot write catalogue checkpoint: "s + temporary_path);
+        }
+    }
+    SyncFile(temporary_path);
+    filesystem::rename(temporary_path, checkpoint_path_);
+    OpenLog(true);
+}
+
+void CatalogueStore::SaveHierarchy(CatalogueSnapshot& snapshot) {
+    snapshot.Refresh();
+    if (!snapshot.router_) {
+        throw logic_error("Routing settings are not provided"s);
+    }
+    if (!snapshot.router_->HasHierarchy()) {
+        snapshot.router_->BuildHierarchy();
+    }
+
+    const string temporary_path = hierarchy_path_ + ".tmp"s;
+    {
+        ofstream hierarchy_output(temporary_path, ios::binary | ios::trunc);
+        snapshot.router_->SaveHierarchy(hierarchy_output);
+        hierarchy_output.flush();
+        if (!hierarchy_output) {
+            throw runtime_error("Cannot write contraction hierarchy: "s + temporary_path);
+        }
+    }
+    filesystem::rename(temporary_path, hierarchy_path_);
+}
+
+size_t CatalogueStore::GetLogTailSize() const {
+    return log_tail_size_;
+}
+
+void CatalogueStore::LoadHierarchy(CatalogueSnapshot& snapshot) const {
+    ifstream hierarchy_input(hierarchy_path_, ios::binary);
+    if (!hierarchy_input || !snapshot.router_) {
+        return;
+    }
+    try {
+        snapshot.router_->LoadHierarchy(hierarchy_input);
+    } catch (const exception& e) {
+        cerr << "Contraction hierarchy is skipped, routes use plain Dijkstra: "s << e.what() << endl;
+    }
+}
+
+void CatalogueStore::OpenLog(bool truncate) {
+    CloseLog();
+    log_ = fopen(log_path_.c_str(), truncate ? "wb" : "ab");
+    if (log_ == nullptr) {
+        throw runtime_error("Cannot open catalogue log: "s + log_path_);
+    }
+    if (truncate) {
+        log_tail_size_ = 0;
+    }
+}
+
+void CatalogueStore::CloseLog() {
+    if (log_ != nullptr) {
+        fclose(log_);
+        log_ = nullptr;
+    }
+}
+
+CatalogueStore::Replayed CatalogueStore::Replay(uint64_t version) const {
+    ifstream checkpoint_input(checkpoint_path_, ios::binary);
+    if (!checkpoint_input) {
+        throw runtime_error("Cannot open catalogue checkpoint: "s + checkpoint_path_);
+    }
+    Checkpoint checkpoint = LoadCheckpoint(checkpoint_input, version);
+    Replayed replayed;
+    replayed.sequence_ = checkpoint.sequence_;
+
+    ifstream log_input(log_path_, ios::binary);
+    if (log_input) {
+        for (const LoggedChange& logged : ReadLoggedChanges(log_input)) {
+            if (logged.sequence_ <= replayed.sequence_) {
+                continue;
+            }
+            ApplyChange(*checkpoint.snapshot_, logged.change_);
+            replayed.sequence_ = logged.sequence_;
+            ++replayed.log_tail_size_;
+        }
+        log_input.clear();
+        replayed.log_valid_size_ = static_cast<streamoff>(log_input.tellg());
+    }
+
+    checkpoint.snapshot_->Refresh();
+    LoadHierarchy(*checkpoint.snapshot_);
+    replayed.snapshot_ = move(checkpoint.snapshot_);
+    return replayed;
+}
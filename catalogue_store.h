@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "catalogue_snapshot.h"
+
+enum class ChangeType : uint8_t {
+    RemoveBus = 1,
+    UpdateBusRoute,
+    MoveStop,
+    UpdateDistance
+};
+
+struct CatalogueChange {
+    ChangeType type_ = ChangeType::RemoveBus;
+    std::string name_;
+    std::string other_name_;
+    std::vector<std::string> route_;
+    bool is_round_ = false;
+    Geo::Coordinates coords_;
+    uint32_t distance_ = 0;
+};
+
+struct LoggedChange {
+    uint64_t sequence_ = 0;
+    CatalogueChange change_;
+};
+
+void ValidateChange(const CatalogueSnapshot& snapshot, const CatalogueChange& change);
+void ApplyChange(CatalogueSnapshot& snapshot, const CatalogueChange& change);
+
+void WriteLoggedChange(const LoggedChange& logged, std::ostream& out);
+std::vector<LoggedChange> ReadLoggedChanges(std::istream& in);
+
+struct Checkpoint {
+    std::unique_ptr<CatalogueSnapshot> snapshot_;
+    uint64_t sequence_ = 0;
+};
+
+void SaveCheckpoint(const CatalogueSnapshot& snapshot, uint64_t sequence, std::ostream& out);
+Checkpoint LoadCheckpoint(std::istream& in, uint64_t version = 0);
+
+class CatalogueStore {
+public:
+    explicit CatalogueStore(const std::string& directory);
+    CatalogueStore(const CatalogueStore&) = delete;
+    CatalogueStore& operator=(const CatalogueStore&) = delete;
+    ~CatalogueStore();
+
+    bool HasCheckpoint() const;
+    std::unique_ptr<CatalogueSnapshot> Open(uint64_t version = 0);
+    std::unique_ptr<CatalogueSnapshot> Read(uint64_t version = 0) const;
+    void Apply(CatalogueSnapshot& snapshot, const CatalogueChange& change);
+    void MakeCheckpoint(const CatalogueSnapshot& snapshot);
+    void SaveHierarchy(CatalogueSnapshot& snapshot);
+    size_t GetLogTailSize() const;
+
+private:
+    struct Replayed {
+        std::unique_ptr<CatalogueSnapshot> snapshot_;
+        uint64_t sequence_ = 0;
+        size_t log_tail_size_ = 0;
+        std::streamoff log_valid_size_ = -1;
+    };
+
+    Replayed Replay(uint64_t version) const;
+    void OpenLog(bool truncate);
+    void CloseLog();
+    void LoadHierarchy(CatalogueSnapshot& snapshot) const;
+
+    std::string checkpoint_path_;
+    std::string log_path_;
+    std::string hierarchy_path_;
+    std::FILE* log_ = nullptr;
+    uint64_t sequence_ = 0;
+    size_t log_tail_size_ = 0;
+};
@@ -0,0 +1,408 @@
+#include "contraction_hierarchy.h"
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+#include "binary_io.h"
+
+using namespace std;
+using namespace binary_io;
+
+namespace graph {
+
+namespace {
+
+const uint32_t HIERARCHY_MAGIC = 0x48434354;
+const uint32_t HIERARCHY_FORMAT = 1;
+const size_t WITNESS_SETTLED_LIMIT = 500;
+const size_t PRIORITY_SETTLED_LIMIT = 50;
+const double INFINITE_WEIGHT = numeric_limits<double>::infinity();
+const EdgeId NO_EDGE = numeric_limits<EdgeId>::max();
+
+uint64_t ComputeFingerprint(const DirectedWeightedGraph<double>& graph) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint64_t value) {
+        hash = (hash ^ value) * 1099511628211ull;
+    };
+    mix(graph.GetVertexCount());
+    for (EdgeId id = 0; id < graph.GetEdgeCount(); ++id) {
+        const Edge<double>& edge = graph.GetEdge(id);
+        mix(edge.from_);
+        mix(edge.to_);
+        mix(bit_cast<uint64_t>(edge.weight_));
+    }
+    return hash;
+}
+
+using QueueItem = pair<double, VertexId>;
+using MinQueue = priority_queue<QueueItem, vector<QueueItem>, greater<QueueItem>>;
+
+struct SearchSpace {
+    vector<double> weights_[2];
+    vector<VertexId> parents_[2];
+    vector<EdgeId> parent_edges_[2];
+    vector<VertexId> touched_;
+
+    void Prepare(size_t vertex_count) {
+        for (int direction = 0; direction < 2; ++direction) {
+            if (weights_[direction].size() < vertex_count) {
+                weights_[direction].resize(vertex_count, INFINITE_WEIGHT);
+                parents_[direction].resize(vertex_count);
+                parent_edges_[direction].resize(vertex_count, NO_EDGE);
+            }
+        }
+    }
+
+    void Reach(int direction, VertexId vertex, double weight, VertexId parent, EdgeId edge) {
+        if (weights_[0][vertex] == INFINITE_WEIGHT && weights_[1][vertex] == INFINITE_WEIGHT) {
+            touched_.push_back(vertex);
+        }
+        weights_[direction][vertex] = weight;
+        parents_[direction][vertex] = parent;
+        parent_edges_[direction][vertex] = edge;
+    }
+
+    void Reset() {
+        for (VertexId vertex : touched_) {
+            for (int direction = 0; direction < 2; ++direction) {
+                weights_[direction][vertex] = INFINITE_WEIGHT;
+                parent_edges_[direction][vertex] = NO_EDGE;
+            }
+        }
+        touched_.clear();
+    }
+};
+
+}
+
+class ContractionHierarchy::Contractor {
+public:
+    explicit Contractor(ContractionHierarchy& hierarchy)
+        : hierarchy_(hierarchy)
+        , edges_count_(hierarchy.graph_.GetEdgeCount())
+        , out_(hierarchy.graph_.GetVertexCount())
+        , in_(hierarchy.graph_.GetVertexCount())
+        , up_(hierarchy.graph_.GetVertexCount())
+        , down_(hierarchy.graph_.GetVertexCount())
+        , contracted_(hierarchy.graph_.GetVertexCount(), false)
+        , contracted_neighbors_(hierarchy.graph_.GetVertexCount(), 0)
+        , witness_weights_(hierarchy.graph_.GetVertexCount(), INFINITE_WEIGHT) {
+        for (EdgeId id = 0; id < edges_count_; ++id) {
+            const Edge<double>& edge = hierarchy.graph_.GetEdge(id);
+            if (edge.from_ != edge.to_) {
+                AddArc(edge.from_, edge.to_, edge.weight_, id);
+            }
+        }
+    }
+
+    void Run() {
+        const size_t vertex_count = out_.size();
+        priority_queue<pair<int64_t, VertexId>, vector<pair<int64_t, VertexId>>, greater<>> queue;
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            queue.push({ComputePriority(vertex), vertex});
+        }
+
+        hierarchy_.ranks_.assign(vertex_count, 0);
+        uint32_t rank = 0;
+        while (!queue.empty()) {
+            VertexId vertex = queue.top().second;
+            queue.pop();
+            const int64_t priority = ComputePriority(vertex);
+            if (!queue.empty() && priority > queue.top().first) {
+                queue.push({priority, vertex});
+                continue;
+            }
+            ContractVertex(vertex);
+            hierarchy_.ranks_[vertex] = rank++;
+        }
+
+        Flatten(up_, hierarchy_.up_offsets_, hierarchy_.up_arcs_);
+        Flatten(down_, hierarchy_.down_offsets_, hierarchy_.down_arcs_);
+    }
+
+private:
+    void AddArc(VertexId from, VertexId to, double weight, EdgeId edge) {
+        auto out_it = find_if(out_[from].begin(), out_[from].end(), [to](const Arc& arc) {
+            return arc.vertex_ == to;
+        });
+        if (out_it != out_[from].end()) {
+            if (out_it->weight_ <= weight) {
+                return;
+            }
+            auto in_it = find_if(in_[to].begin(), in_[to].end(), [from](const Arc& arc) {
+                return arc.vertex_ == from;
+            });
+            *out_it = {to, weight, edge};
+            *in_it = {from, weight, edge};
+            return;
+        }
+        out_[from].push_back({to, weight, edge});
+        in_[to].push_back({from, weight, edge});
+    }
+
+    void RunWitnessSearch(VertexId source, VertexId excluded, double limit, size_t settled_limit) {
+        for (VertexId vertex : witness_touched_) {
+            witness_weights_[vertex] = INFINITE_WEIGHT;
+        }
+        witness_touched_.clear();
+
+        MinQueue queue;
+        witness_weights_[source] = 0.0;
+        witness_touched_.push_back(source);
+        queue.push({0.0, source});
+
+        size_t settled = 0;
+        while (!queue.empty() && settled < settled_limit) {
+            auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > witness_weights_[vertex]) {
+                continue;
+            }
+            if (weight > limit) {
+                break;
+            }
+            ++settled;
+            for (const Arc& arc : out_[vertex]) {
+                if (arc.vertex_ == excluded) {
+                    continue;
+                }
+                const double new_weight = weight + arc.weight_;
+                if (new_weight < witness_weights_[arc.vertex_]) {
+                    if (witness_weights_[arc.vertex_] == INFINITE_WEIGHT) {
+                        witness_touched_.push_back(arc.vertex_);
+                    }
+                    witness_weights_[arc.vertex_] = new_weight;
+                    queue.push({new_weight, arc.vertex_});
+                }
+            }
+        }
+    }
+
+    size_t ProcessShortcuts(VertexId vertex, bool add, size_t settled_limit) {
+        size_t shortcuts_count = 0;
+        const vector<Arc> in_arcs = in_[vertex];
+        const vector<Arc> out_arcs = out_[vertex];
+
+        for (const Arc& in_arc : in_arcs) {
+            double limit = 0.0;
+            for (const Arc& out_arc : out_arcs) {
+                if (out_arc.vertex_ != in_arc.vertex_) {
+                    limit = max(limit, in_arc.weight_ + out_arc.weight_);
+                }
+            }
+            RunWitnessSearch(in_arc.vertex_, vertex, limit, settled_limit);
+
+            for (const Arc& out_arc : out_arcs) {
+                const double weight = in_arc.weight_ + out_arc.weight_;
+                if (out_arc.vertex_ == in_arc.vertex_ || witness_weights_[out_arc.vertex_] <= weight) {
+                    continue;
+                }
+                ++shortcuts_count;
+                if (add) {
+                    const EdgeId shortcut_id = edges_count_ + hierarchy_.shortcuts_.size();
+                    hierarchy_.shortcuts_.push_back({in_arc.edge_, out_arc.edge_});
+                    AddArc(in_arc.vertex_, out_arc.vertex_, weight, shortcut_id);
+                }
+            }
+        }
+        return shortcuts_count;
+    }
+
+    int64_t ComputePriority(VertexId vertex) {
+        const int64_t shortcuts_count = static_cast<int64_t>(ProcessShortcuts(vertex, false, PRIORITY_SETTLED_LIMIT));
+        return shortcuts_count - static_cast<int64_t>(in_[vertex].size() + out_[vertex].size())
+            + contracted_neighbors_[vertex];
+    }
+
+    void ContractVertex(VertexId vertex) {
+        ProcessShortcuts(vertex, true, WITNESS_SETTLED_LIMIT);
+
+        up_[vertex] = move(out_[vertex]);
+        down_[vertex] = move(in_[vertex]);
+        out_[vertex].clear();
+        in_[vertex].clear();
+        contracted_[vertex] = true;
+
+        auto drop_vertex = [vertex](vector<Arc>& arcs) {
+            arcs.erase(remove_if(arcs.begin(), arcs.end(), [vertex](const Arc& arc) {
+                return arc.vertex_ == vertex;
+            }), arcs.end());
+        };
+        for (const Arc& arc : up_[vertex]) {
+            drop_vertex(in_[arc.vertex_]);
+            ++contracted_neighbors_[arc.vertex_];
+        }
+        for (const Arc& arc : down_[vertex]) {
+            drop_vertex(out_[arc.vertex_]);
+            ++contracted_neighbors_[arc.vertex_];
+        }
+    }
+
+    static void Flatten(vector<vector<Arc>>& lists, vector<uint64_t>& offsets, vector<Arc>& arcs) {
+        offsets.assign(1, 0);
+        arcs.clear();
+        for (vector<Arc>& list : lists) {
+            arcs.insert(arcs.end(), list.begin(), list.end());
+            offsets.push_back(arcs.size());
+            vector<Arc>().swap(list);
+        }
+    }
+
+    ContractionHierarchy& hierarchy_;
+    const size_t edges_count_;
+    vector<vector<Arc>> out_;
+    vector<vector<Arc>> in_;
+    vector<vector<Arc>> up_;
+    vector<vector<Arc>> down_;
+    vector<bool> contracted_;
+    vector<int64_t> contracted_neighbors_;
+    vector<double> witness_weights_;
+    vector<VertexId> witness_touched_;
+};
+
+ContractionHierarchy::ContractionHierarchy(const Graph& graph)
+    : graph_(graph)
+    , fingerprint_(ComputeFingerprint(graph)) {
+    Contract();
+}
+
+ContractionHierarchy::ContractionHierarchy(const Graph& graph, istream& in)
+    : graph_(graph)
+    , fingerprint_(ComputeFingerprint(graph)) {
+    if (ReadValue<uint32_t>(in) != HIERARCHY_MAGIC || ReadValue<uint32_t>(in) != HIERARCHY_FORMAT
+        || ReadValue<uint32_t>(in) != sizeof(Arc)) {
+        throw runtime_error("Unsupported contraction hierarchy format"s);
+    }
+    if (ReadValue<uint64_t>(in) != fingerprint_) {
+        throw runtime_error("The contraction hierarchy was built for another routing graph"s);
+    }
+    ranks_ = ReadVector<uint32_t>(in);
+    shortcuts_ = ReadVector<Shortcut>(in);
+    up_offsets_ = ReadVector<uint64_t>(in);
+    up_arcs_ = ReadVector<Arc>(in);
+    down_offsets_ = ReadVector<uint64_t>(in);
+    down_arcs_ = ReadVector<Arc>(in);
+
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (ranks_.size() != vertex_count || up_offsets_.size() != vertex_count + 1
+        || down_offsets_.size() != vertex_count + 1
+        || up_offsets_.back() != up_arcs_.size() || down_offsets_.back() != down_arcs_.size()) {
+        throw runtime_error("The contraction hierarchy is corrupted"s);
+    }
+}
+
+optional<ContractionHierarchy::RouteInfo> ContractionHierarchy::BuildRoute(VertexId from, VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        return nullopt;
+    }
+
+    static thread_local SearchSpace space;
+    space.Prepare(vertex_count);
+    MinQueue queues[2];
+    space.Reach(0, from, 0.0, from, NO_EDGE);
+    space.Reach(1, to, 0.0, to, NO_EDGE);
+    queues[0].push({0.0, from});
+    queues[1].push({0.0, to});
+
+    double best = INFINITE_WEIGHT;
+    VertexId meeting = vertex_count;
+    while (true) {
+        int direction = -1;
+        for (int candidate = 0; candidate < 2; ++candidate) {
+            if (queues[candidate].empty() || queues[candidate].top().first >= best) {
+                continue;
+            }
+            if (direction == -1 || queues[candidate].top().first < queues[direction].top().first) {
+                direction = candidate;
+            }
+        }
+        if (direction == -1) {
+            break;
+        }
+
+        auto [weight, vertex] = queues[direction].top();
+        queues[direction].pop();
+        if (weight > space.weights_[direction][vertex]) {
+            continue;
+        }
+        const double other_weight = space.weights_[1 - direction][vertex];
+        if (weight + other_weight < best) {
+            best = weight + other_weight;
+            meeting = vertex;
+        }
+
+        const vector<uint64_t>& offsets = direction == 0 ? up_offsets_ : down_offsets_;
+        const vector<Arc>& arcs = direction == 0 ? up_arcs_ : down_arcs_;
+        for (uint64_t i = offsets[vertex]; i < offsets[vertex + 1]; ++i) {
+            const Arc& arc = arcs[i];
+            const double new_weight = weight + arc.weight_;
+            if (new_weight < space.weights_[direction][arc.vertex_]) {
+                space.Reach(direction, arc.vertex_, new_weight, vertex, arc.edge_);
+                queues[direction].push({new_weight, arc.vertex_});
+            }
+        }
+    }
+
+    if (meeting == vertex_count) {
+        space.Reset();
+        return nullopt;
+    }
+
+    vector<EdgeId> forward_edges;
+    for (VertexId vertex = meeting; vertex != from; vertex = space.parents_[0][vertex]) {
+        forward_edges.push_back(space.parent_edges_[0][vertex]);
+    }
+    reverse(forward_edges.begin(), forward_edges.end());
+    for (VertexId vertex = meeting; vertex != to; vertex = space.parents_[1][vertex]) {
+        forward_edges.push_back(space.parent_edges_[1][vertex]);
+    }
+    space.Reset();
+
+    RouteInfo route{best, {}};
+    for (EdgeId edge : forward_edges) {
+        UnpackEdge(edge, route.edges_);
+    }
+    return route;
+}
+
+void ContractionHierarchy::Save(ostream& out) const {
+    WriteValue<uint32_t>(out, HIERARCHY_MAGIC);
+    WriteValue<uint32_t>(out, HIERARCHY_FORMAT);
+    WriteValue<uint32_t>(out, sizeof(Arc));
+    WriteValue<uint64_t>(out, fingerprint_);
+    WriteVector(out, ranks_);
+    WriteVector(out, shortcuts_);
+    WriteVector(out, up_offsets_);
+    WriteVector(out, up_arcs_);
+    WriteVector(out, down_offsets_);
+    WriteVector(out, down_arcs_);
+}
+
+size_t ContractionHierarchy::GetShortcutsCount() const {
+    return shortcuts_.size();
+}
+
+void ContractionHierarchy::Contract() {
+    Contractor(*this).Run();
+}
+
+void ContractionHierarchy::UnpackEdge(EdgeId edge, vector<EdgeId>& path) const {
+    const size_t edges_count = graph_.GetEdgeCount();
+    vector<EdgeId> stack{edge};
+    while (!stack.empty()) {
+        EdgeId current = stack.back();
+        stack.pop_back();
+        if (current < edges_count) {
+            path.push_back(current);
+            continue;
+        }
+        const Shortcut& shortcut = shortcuts_.at(current - edges_count);
+        stack.push_back(shortcut.second_);
+        stack.push_back(shortcut.first_);
+    }
+}
+
+}
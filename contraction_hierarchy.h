@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <vector>
+
+#include "graph.h"
+#include "router.h"
+
+namespace graph {
+
+class ContractionHierarchy {
+public:
+    using Graph = DirectedWeightedGraph<double>;
+    using RouteInfo = Router<double>::RouteInfo;
+
+    explicit ContractionHierarchy(const Graph& graph);
+    ContractionHierarchy(const Graph& graph, std::istream& in);
+    ContractionHierarchy(const ContractionHierarchy&) = delete;
+    ContractionHierarchy& operator=(const ContractionHierarchy&) = delete;
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    void Save(std::ostream& out) const;
+    size_t GetShortcutsCount() const;
+
+private:
+    struct Arc {
+        VertexId vertex_;
+        double weight_;
+        EdgeId edge_;
+    };
+
+    struct Shortcut {
+        EdgeId first_;
+        EdgeId second_;
+    };
+
+    class Contractor;
+
+    void Contract();
+    void UnpackEdge(EdgeId edge, std::vector<EdgeId>& path) const;
+
+    const Graph& graph_;
+    uint64_t fingerprint_ = 0;
+    std::vector<uint32_t> ranks_;
+    std::vector<Shortcut> shortcuts_;
+    std::vector<uint64_t> up_offsets_;
+    std::vector<Arc> up_arcs_;
+    std::vector<uint64_t> down_offsets_;
+    std::vector<Arc> down_arcs_;
+};
+
+}
@@ -8,11 +8,12 @@ Stop::Stop(const std::string& name)
 Stop::Stop(std::string&& name)
     : name_(std::move(name)) {}
 
-Stop::Stop(const std::string& name, Geo::Coordinates coords)
-    : name_(name), coords_(coords) {}
+Stop::Stop(std::string&& name, const Geo::CoordinatesArray* coords_array, uint32_t index)
+    : name_(std::move(name)), coords_array_(coords_array), index_(index) {}
 
-Stop::Stop(std::string&& name, Geo::Coordinates coords)
-    : name_(std::move(name)), coords_(coords) {}
+Geo::Coordinates Stop::GetCoordinates() const {
+    return coords_array_->Get(index_);
+}
 
 void Stop::AddNeighborStop(Stop* stop_ptr, uint32_t distance) {
     neighbor_stops_dist_[stop_ptr] = distance;
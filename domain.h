@@ -2,6 +2,7 @@
 #include<vector>
 #include<string>
 #include<unordered_map>
+#include<unordered_set>
 #include<cstdint>
 #include<set>
 #include"geo.h"
@@ -10,9 +11,9 @@ struct Stop {
     Stop();
     Stop(const std::string& name);
     Stop(std::string&& name);
-    Stop(const std::string& name, Geo::Coordinates coords);
-    Stop(std::string&& name, Geo::Coordinates coords);
+    Stop(std::string&& name, const Geo::CoordinatesArray* coords_array, uint32_t index);
 
+    Geo::Coordinates GetCoordinates() const;
     void AddNeighborStop(Stop* stop_ptr, uint32_t distance);
 
     bool operator==(const Stop& other) const;
@@ -22,8 +23,10 @@ struct Stop {
     bool operator>=(const Stop& other) const;
 
     std::string name_;
-    Geo::Coordinates coords_;
+    const Geo::CoordinatesArray* coords_array_ = nullptr;
+    uint32_t index_ = 0;
     std::unordered_map<const Stop*, uint32_t> neighbor_stops_dist_;
+    std::unordered_set<const Stop*> implied_neighbors_;
 };
 
 struct Bus {
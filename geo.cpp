@@ -1,12 +1,211 @@
 #include "geo.h"
 
+#include <array>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define GEO_AVX2_KERNEL
+#endif
+
 using namespace std;
 
+namespace {
+
+const size_t AVX2_LANES = 4;
+const size_t FIXED_POINT_LANES = 8;
+const double ASIN_SERIES_LIMIT = 0.5;
+const double ASIN_P[] = {1.66666666666666657415e-01, -3.25565818622400915405e-01, 2.01212532134862925881e-01,
+    -4.00555345006794114027e-02, 7.91534994289814532176e-04, 3.47933107596021167570e-05};
+const double ASIN_Q[] = {-2.40339491173441421878e+00, 2.02094576023350569471e+00, -6.88283971605453293030e-01,
+    7.70381505559019352791e-02};
+
+double ComputeSquaredChord(const double* x, const double* y, const double* z, uint32_t from, uint32_t to) {
+    const double dx = x[from] - x[to];
+    const double dy = y[from] - y[to];
+    const double dz = z[from] - z[to];
+    return dx * dx + dy * dy + dz * dz;
+}
+
+double Sinc(double x) {
+    return x == 0.0 ? 1.0 : sin(x) / x;
+}
+
+double AsinSeries(double x) {
+    const double t = x * x;
+    const double p = t * (ASIN_P[0] + t * (ASIN_P[1] + t * (ASIN_P[2] + t * (ASIN_P[3] + t * (ASIN_P[4] + t * ASIN_P[5])))));
+    const double q = 1.0 + t * (ASIN_Q[0] + t * (ASIN_Q[1] + t * (ASIN_Q[2] + t * ASIN_Q[3])));
+    return x + x * (p / q);
+}
+
+double HalfChordToDistance(double half_chord) {
+    return 2.0 * (half_chord < ASIN_SERIES_LIMIT ? AsinSeries(half_chord) : asin(half_chord)) * EARTH_RADIUS;
+}
+
+#ifdef GEO_AVX2_KERNEL
+__attribute__((target("avx2")))
+inline __m256d Gather(const double* values, __m128i indexes) {
+    const __m256d all_lanes = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), values, indexes, all_lanes, 8);
+}
+
+__attribute__((target("avx2")))
+size_t ComputeSquaredChordsAvx2(const double* x, const double* y, const double* z,
+    const uint32_t* from, size_t from_step, const uint32_t* to, double* chords, size_t count) {
+    size_t i = 0;
+    for (; i + AVX2_LANES <= count; i += AVX2_LANES) {
+        const __m128i from_indexes = from_step == 0
+            ? _mm_set1_epi32(static_cast<int>(*from))
+            : _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+        const __m128i to_indexes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(to + i));
+
+        const __m256d dx = _mm256_sub_pd(Gather(x, from_indexes), Gather(x, to_indexes));
+        const __m256d dy = _mm256_sub_pd(Gather(y, from_indexes), Gather(y, to_indexes));
+        const __m256d dz = _mm256_sub_pd(Gather(z, from_indexes), Gather(z, to_indexes));
+        const __m256d squared = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)),
+            _mm256_mul_pd(dz, dz));
+        _mm256_storeu_pd(chords + i, squared);
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+inline __m256d Horner(__m256d t, const double* coefficients, size_t count) {
+    __m256d result = _mm256_set1_pd(coefficients[count - 1]);
+    for (size_t i = count - 1; i > 0; --i) {
+        result = _mm256_add_pd(_mm256_set1_pd(coefficients[i - 1]), _mm256_mul_pd(t, result));
+    }
+    return result;
+}
+
+__attribute__((target("avx2")))
+size_t ChordsToDistancesAvx2(double* values, size_t count, bool is_exact) {
+    const __m256d two = _mm256_set1_pd(2.0);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d series_limit = _mm256_set1_pd(ASIN_SERIES_LIMIT);
+    const __m256d radius = _mm256_set1_pd(EARTH_RADIUS);
+    size_t i = 0;
+    for (; i + AVX2_LANES <= count; i += AVX2_LANES) {
+        const __m256d chord = _mm256_sqrt_pd(_mm256_loadu_pd(values + i));
+        if (!is_exact) {
+            _mm256_storeu_pd(values + i, chord);
+            continue;
+        }
+        const __m256d x = _mm256_min_pd(one, _mm256_div_pd(chord, two));
+        const __m256d t = _mm256_mul_pd(x, x);
+        const __m256d p = _mm256_mul_pd(t, Horner(t, ASIN_P, size(ASIN_P)));
+        const __m256d q = _mm256_add_pd(one, _mm256_mul_pd(t, Horner(t, ASIN_Q, size(ASIN_Q))));
+        const __m256d angle = _mm256_add_pd(x, _mm256_mul_pd(x, _mm256_div_pd(p, q)));
+        _mm256_storeu_pd(values + i, _mm256_mul_pd(_mm256_mul_pd(two, angle), radius));
+
+        const int wide_lanes = _mm256_movemask_pd(_mm256_cmp_pd(x, series_limit, _CMP_GE_OQ));
+        if (wide_lanes != 0) {
+            array<double, AVX2_LANES> half_chords;
+            _mm256_storeu_pd(half_chords.data(), x);
+            for (size_t lane = 0; lane < AVX2_LANES; ++lane) {
+                if (wide_lanes & (1 << lane)) {
+                    values[i + lane] = HalfChordToDistance(half_chords[lane]);
+                }
+            }
+        }
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+size_t ScanBoundsAvx2(const double* lats, const double* lngs, size_t count, array<double, 4>& bounds) {
+    if (count < AVX2_LANES) {
+        return 0;
+    }
+    __m256d min_lat = _mm256_loadu_pd(lats);
+    __m256d max_lat = min_lat;
+    __m256d min_lng = _mm256_loadu_pd(lngs);
+    __m256d max_lng = min_lng;
+    size_t i = AVX2_LANES;
+    for (; i + AVX2_LANES <= count; i += AVX2_LANES) {
+        const __m256d lat = _mm256_loadu_pd(lats + i);
+        const __m256d lng = _mm256_loadu_pd(lngs + i);
+        min_lat = _mm256_min_pd(min_lat, lat);
+        max_lat = _mm256_max_pd(max_lat, lat);
+        min_lng = _mm256_min_pd(min_lng, lng);
+        max_lng = _mm256_max_pd(max_lng, lng);
+    }
+
+    array<double, AVX2_LANES> lanes[4];
+    _mm256_storeu_pd(lanes[0].data(), min_lat);
+    _mm256_storeu_pd(lanes[1].data(), max_lat);
+    _mm256_storeu_pd(lanes[2].data(), min_lng);
+    _mm256_storeu_pd(lanes[3].data(), max_lng);
+    for (size_t lane = 0; lane < AVX2_LANES; ++lane) {
+        bounds[0] = min(bounds[0], lanes[0][lane]);
+        bounds[1] = max(bounds[1], lanes[1][lane]);
+        bounds[2] = min(bounds[2], lanes[2][lane]);
+        bounds[3] = max(bounds[3], lanes[3][lane]);
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+size_t ScanBoundsAvx2(const int32_t* lats, const int32_t* lngs, size_t count, array<int32_t, 4>& bounds) {
+    if (count < FIXED_POINT_LANES) {
+        return 0;
+    }
+    __m256i min_lat = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lats));
+    __m256i max_lat = min_lat;
+    __m256i min_lng = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lngs));
+    __m256i max_lng = min_lng;
+    size_t i = FIXED_POINT_LANES;
+    for (; i + FIXED_POINT_LANES <= count; i += FIXED_POINT_LANES) {
+        const __m256i lat = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lats + i));
+        const __m256i lng = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lngs + i));
+        min_lat = _mm256_min_epi32(min_lat, lat);
+        max_lat = _mm256_max_epi32(max_lat, lat);
+        min_lng = _mm256_min_epi32(min_lng, lng);
+        max_lng = _mm256_max_epi32(max_lng, lng);
+    }
+
+    array<int32_t, FIXED_POINT_LANES> lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes[0].data()), min_lat);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes[1].data()), max_lat);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes[2].data()), min_lng);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes[3].data()), max_lng);
+    for (size_t lane = 0; lane < FIXED_POINT_LANES; ++lane) {
+        bounds[0] = min(bounds[0], lanes[0][lane]);
+        bounds[1] = max(bounds[1], lanes[1][lane]);
+        bounds[2] = min(bounds[2], lanes[2][lane]);
+        bounds[3] = max(bounds[3], lanes[3][lane]);
+    }
+    return i;
+}
+
+bool HasAvx2() {
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+}
+#endif
+
+template <typename Value>
+array<Value, 4> ScanBounds(const vector<Value>& lats, const vector<Value>& lngs) {
+    array<Value, 4> bounds{lats.front(), lats.front(), lngs.front(), lngs.front()};
+    size_t done = 0;
+#ifdef GEO_AVX2_KERNEL
+    if (HasAvx2()) {
+        done = ScanBoundsAvx2(lats.data(), lngs.data(), lats.size(), bounds);
+    }
+#endif
+    for (size_t i = done; i < lats.size(); ++i) {
+        bounds[0] = min(bounds[0], lats[i]);
+        bounds[1] = max(bounds[1], lats[i]);
+        bounds[2] = min(bounds[2], lngs[i]);
+        bounds[3] = max(bounds[3], lngs[i]);
+    }
+    return bounds;
+}
+
+}
+
 namespace Geo {
     Coordinates::Coordinates() = default;
     Coordinates::Coordinates(const double l, const double r) : lat(l), lng(r) {}
-    Coordinates::Coordinates(const Coordinates& coord) : lat(coord.lat), lng(coord.lng) {}
-    Coordinates::Coordinates(Coordinates&& coord) : lat(coord.lat), lng(coord.lng) {}
 
     bool Coordinates::operator==(const Coordinates& other) const {
         return IsEqualDouble(lat, other.lat) && IsEqualDouble(lng, other.lng);
@@ -15,10 +214,115 @@ namespace Geo {
         return !(*this == other);
     }
 
-    Coordinates& Coordinates::operator=(const Coordinates& other) {
-        lat = other.lat;
-        lng = other.lng;
-        return *this;
+    CoordinatesArray::CoordinatesArray(CoordinatesEncoding encoding) : encoding_(encoding) {}
+
+    CoordinatesEncoding CoordinatesArray::GetEncoding() const {
+        return encoding_;
+    }
+
+    size_t CoordinatesArray::GetSize() const {
+        return encoding_ == CoordinatesEncoding::FixedPoint ? fixed_lats_.size() : lats_.size();
+    }
+
+    bool CoordinatesArray::IsEmpty() const {
+        return GetSize() == 0;
+    }
+
+    Coordinates CoordinatesArray::Get(size_t index) const {
+        if (encoding_ == CoordinatesEncoding::FixedPoint) {
+            return {fixed_lats_[index] / FIXED_POINT_UNITS, fixed_lngs_[index] / FIXED_POINT_UNITS};
+        }
+        return {lats_[index], lngs_[index]};
+    }
+
+    bool CoordinatesArray::CanStore(Coordinates coords) const {
+        if (encoding_ == CoordinatesEncoding::FixedPoint) {
+            return IsInFixedPointRange(coords.lat) && IsInFixedPointRange(coords.lng);
+        }
+        return isfinite(coords.lat) && isfinite(coords.lng);
+    }
+
+    void CoordinatesArray::Reserve(size_t count) {
+        if (encoding_ == CoordinatesEncoding::FixedPoint) {
+            fixed_lats_.reserve(count);
+            fixed_lngs_.reserve(count);
+        } else {
+            lats_.reserve(count);
+            lngs_.reserve(count);
+        }
+    }
+
+    void CoordinatesArray::PushBack(Coordinates coords) {
+        if (encoding_ == CoordinatesEncoding::FixedPoint) {
+            fixed_lats_.push_back(ToFixedPoint(coords.lat));
+            fixed_lngs_.push_back(ToFixedPoint(coords.lng));
+        } else {
+            lats_.push_back(coords.lat);
+            lngs_.push_back(coords.lng);
+        }
+    }
+
+    void CoordinatesArray::Set(size_t index, Coordinates coords) {
+        if (encoding_ == CoordinatesEncoding::FixedPoint) {
+            fixed_lats_.at(index) = ToFixedPoint(coords.lat);
+            fixed_lngs_.at(index) = ToFixedPoint(coords.lng);
+        } else {
+            lats_.at(index) = coords.lat;
+            lngs_.at(index) = coords.lng;
+        }
+    }
+
+    void CoordinatesArray::Clear() {
+        lats_.clear();
+        lngs_.clear();
+        fixed_lats_.clear();
+        fixed_lngs_.clear();
+    }
+
+    bool CoordinatesArray::IsInFixedPointRange(double degrees) {
+        return abs(degrees) <= 180.0;
+    }
+
+    int32_t CoordinatesArray::ToFixedPoint(double degrees) {
+        if (!IsInFixedPointRange(degrees)) {
+            throw out_of_range("Coordinate is out of fixed-point range: "s + to_string(degrees));
+        }
+        return static_cast<int32_t>(lround(degrees * FIXED_POINT_UNITS));
+    }
+
+    SphereProjector::SphereProjector(const CoordinatesArray& points, double max_width, double max_height, double padding)
+    : padding_(padding) {
+        if (points.IsEmpty()) {
+            return;
+        }
+
+        double min_lat = 0.0;
+        double max_lon = 0.0;
+        points.Visit([&](const auto& lats, const auto& lngs, double units) {
+            const auto bounds = ScanBounds(lats, lngs);
+            min_lat = bounds[0] / units;
+            max_lat_ = bounds[1] / units;
+            min_lon_ = bounds[2] / units;
+            max_lon = bounds[3] / units;
+        });
+
+        optional<double> width_zoom;
+        if (!IsZero(max_lon - min_lon_)) {
+            width_zoom = (max_width - 2 * padding) / (max_lon - min_lon_);
+        }
+
+        optional<double> height_zoom;
+        if (!IsZero(max_lat_ - min_lat)) {
+            height_zoom = (max_height - 2 * padding) / (max_lat_ - min_lat);
+        }
+
+        if (width_zoom && height_zoom) {
+            zoom_coeff_ = min(*width_zoom, *height_zoom);
+        } else if (width_zoom) {
+            zoom_coeff_ = *width_zoom;
+        } else if (height_zoom) {
+            zoom_coeff_ = *height_zoom;
+        }
     }
 
     svg::Point SphereProjector::RescaleCoordinates(Coordinates coords) const {
@@ -27,4 +331,173 @@ namespace Geo {
             (max_lat_ - coords.lat) * zoom_coeff_ + padding_
         };
     }
+
+    void SphereProjector::RescaleCoordinates(const CoordinatesArray& points, vector<svg::Point>& result) const {
+        result.resize(points.GetSize());
+        points.Visit([&](const auto& lats, const auto& lngs, double units) {
+            const double degrees_per_unit = 1.0 / units;
+            for (size_t i = 0; i < result.size(); ++i) {
+                result[i].x = (lngs[i] * degrees_per_unit - min_lon_) * zoom_coeff_ + padding_;
+                result[i].y = (max_lat_ - lats[i] * degrees_per_unit) * zoom_coeff_ + padding_;
+            }
+        });
+    }
+
+    DistanceTable::DistanceTable(const vector<Coordinates>& points, DistanceMode mode)
+    : DistanceTable(CoordinatesArray(points.begin(), points.end()), mode) {
+    }
+
+    DistanceTable::DistanceTable(const CoordinatesArray& points, DistanceMode mode)
+    : mode_(mode) {
+        if (mode_ == DistanceMode::Approximate) {
+            ProjectEquirectangular(points);
+            return;
+        }
+        x_.resize(points.GetSize());
+        y_.resize(points.GetSize());
+        z_.resize(points.GetSize());
+        points.Visit([&](const auto& lats, const auto& lngs, double units) {
+            for (size_t i = 0; i < lats.size(); ++i) {
+                ProjectOnSphere(i, lats[i] / units, lngs[i] / units);
+            }
+        });
+    }
+
+    DistanceMode DistanceTable::GetMode() const {
+        return mode_;
+    }
+
+    double DistanceTable::GetRelativeErrorBound() const {
+        return relative_error_bound_;
+    }
+
+    size_t DistanceTable::GetPointsCount() const {
+        return x_.size();
+    }
+
+    double DistanceTable::ComputeDistance(uint32_t from, uint32_t to) const {
+        return ToDistance(ComputeSquaredChord(x_.data(), y_.data(), z_.data(), from, to));
+    }
+
+    void DistanceTable::ComputeDistances(uint32_t from, const uint32_t* to, double* distances, size_t count) const {
+        ComputeBatch(&from, 0, to, distances, count);
+    }
+
+    void DistanceTable::ComputeDistances(const uint32_t* from, const uint32_t* to, double* distances, size_t count) const {
+        ComputeBatch(from, 1, to, distances, count);
+    }
+
+    double DistanceTable::ComputePathLength() const {
+        if (GetPointsCount() < 2) {
+            return 0.0;
+        }
+        vector<uint32_t> indexes(GetPointsCount());
+        for (size_t i = 0; i < indexes.size(); ++i) {
+            indexes[i] = static_cast<uint32_t>(i);
+        }
+        vector<double> distances(GetPointsCount() - 1);
+        ComputeBatch(indexes.data(), 1, indexes.data() + 1, distances.data(), distances.size());
+
+        double result = 0.0;
+        for (double distance : distances) {
+            result += distance;
+        }
+        return result;
+    }
+
+    void DistanceTable::PushBack(Coordinates coords) {
+        x_.push_back(0.0);
+        y_.push_back(0.0);
+        z_.push_back(0.0);
+        Set(x_.size() - 1, coords);
+    }
+
+    void DistanceTable::Set(size_t index, Coordinates coords) {
+        if (mode_ == DistanceMode::Approximate) {
+            throw logic_error("Approximate distance table can't be updated point by point"s);
+        }
+        ProjectOnSphere(index, coords.lat, coords.lng);
+    }
+
+    double DistanceTable::ChordToDistance(double squared_chord) {
+        return HalfChordToDistance(min(sqrt(squared_chord) / 2.0, 1.0));
+    }
+
+    void DistanceTable::ProjectEquirectangular(const CoordinatesArray& points) {
+        static const double dr = PI / 180.;
+        x_.resize(points.GetSize());
+        y_.resize(points.GetSize());
+        z_.assign(points.GetSize(), 0.0);
+        if (points.IsEmpty()) {
+            return;
+        }
+
+        double min_lat = 0.0;
+        double max_lat = 0.0;
+        double min_lng = 0.0;
+        double max_lng = 0.0;
+        points.Visit([&](const auto& lats, const auto& lngs, double units) {
+            const auto bounds = ScanBounds(lats, lngs);
+            min_lat = bounds[0] / units;
+            max_lat = bounds[1] / units;
+            min_lng = bounds[2] / units;
+            max_lng = bounds[3] / units;
+        });
+
+        const double mean_cos = (cos(min_lat * dr) + cos(max_lat * dr)) / 2.0;
+        const double lng_scale = mean_cos * dr * EARTH_RADIUS;
+        const double lat_scale = dr * EARTH_RADIUS;
+        points.Visit([&](const auto& lats, const auto& lngs, double units) {
+            for (size_t i = 0; i < lats.size(); ++i) {
+                x_[i] = lngs[i] / units * lng_scale;
+                y_[i] = lats[i] / units * lat_scale;
+            }
+        });
+
+        // Haversine: 4 sin^2(d / 2) = 4 sin^2(dlat / 2) + 4 cos(lat1) cos(lat2) sin^2(dlng / 2),
+        // and x sinc(X / 2) <= 2 sin(x / 2) <= x for 0 <= x <= X, so the projected distance
+        // sqrt(dlat^2 + mean_cos^2 dlng^2) is bounded by the extent's cosines and sinc factors.
+        const double lat_extent = (max_lat - min_lat) * dr;
+        const double lng_extent = (max_lng - min_lng) * dr;
+        const double min_cos = min(cos(min_lat * dr), cos(max_lat * dr));
+        const double max_cos = min_lat <= 0.0 && max_lat >= 0.0 ? 1.0 : max(cos(min_lat * dr), cos(max_lat * dr));
+        const double max_half_angle = asin(min(hypot(lat_extent, max_cos * lng_extent) / 2.0, 1.0));
+        const double max_ratio = max(1.0 / Sinc(lat_extent / 2.0), mean_cos / (min_cos * Sinc(lng_extent / 2.0)));
+        const double min_ratio = Sinc(max_half_angle) * min(1.0, mean_cos / max_cos);
+        relative_error_bound_ = max(max_ratio - 1.0, 1.0 - min_ratio);
+    }
+
+    void DistanceTable::ProjectOnSphere(size_t index, double lat, double lng) {
+        static const double dr = PI / 180.;
+        const double cos_lat = cos(lat * dr);
+        x_.at(index) = cos_lat * cos(lng * dr);
+        y_.at(index) = cos_lat * sin(lng * dr);
+        z_.at(index) = sin(lat * dr);
+    }
+
+    double DistanceTable::ToDistance(double squared_chord) const {
+        return mode_ == DistanceMode::Exact ? ChordToDistance(squared_chord) : sqrt(squared_chord);
+    }
+
+    void DistanceTable::ComputeBatch(const uint32_t* from, size_t from_step, const uint32_t* to,
+        double* distances, size_t count) const {
+        size_t done = 0;
+#ifdef GEO_AVX2_KERNEL
+        if (HasAvx2()) {
+            done = ComputeSquaredChordsAvx2(x_.data(), y_.data(), z_.data(), from, from_step, to, distances, count);
+        }
+#endif
+        for (size_t i = done; i < count; ++i) {
+            distances[i] = ComputeSquaredChord(x_.data(), y_.data(), z_.data(), from[i * from_step], to[i]);
+        }
+        done = 0;
+#ifdef GEO_AVX2_KERNEL
+        if (HasAvx2()) {
+            done = ChordsToDistancesAvx2(distances, count, mode_ == DistanceMode::Exact);
+        }
+#endif
+        for (size_t i = done; i < count; ++i) {
+            distances[i] = ToDistance(distances[i]);
+        }
+    }
 }
\ No newline at end of file
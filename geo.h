@@ -1,8 +1,12 @@
 #pragma once
 #include <cmath>
+#include <cstdint>
 #include <iostream>
 #include <algorithm>
 #include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 #include "svg.h"
 
@@ -57,17 +61,16 @@ namespace Geo {
     struct Coordinates {
         Coordinates();
         Coordinates(const double l, const double r);
-        Coordinates(const Coordinates& coord);
-        Coordinates(Coordinates&& coord);
 
         double lat = 0.0;
         double lng = 0.0;
         
         bool operator==(const Coordinates& other) const;
         bool operator!=(const Coordinates& other) const;
-        Coordinates& operator=(const Coordinates& other);
     };
 
+    static_assert(std::is_trivially_copyable_v<Coordinates>);
+
     inline std::ostream& operator <<(std::ostream& os, Coordinates coord) {
         os << coord.lat << ", " << coord.lng;
         return os;
@@ -85,13 +88,108 @@ namespace Geo {
     }
 
 
+    enum class CoordinatesEncoding {
+        Double,
+        FixedPoint
+    };
+
+    class CoordinatesArray {
+    public:
+        static constexpr double FIXED_POINT_UNITS = 1e7;
+
+        explicit CoordinatesArray(CoordinatesEncoding encoding = CoordinatesEncoding::Double);
+        template <std::forward_iterator CoordinatesIt>
+        CoordinatesArray(CoordinatesIt points_begin, CoordinatesIt points_end,
+                         CoordinatesEncoding encoding = CoordinatesEncoding::Double);
+
+        CoordinatesEncoding GetEncoding() const;
+        size_t GetSize() const;
+        bool IsEmpty() const;
+        Coordinates Get(size_t index) const;
+        bool CanStore(Coordinates coords) const;
+
+        void Reserve(size_t count);
+        void PushBack(Coordinates coords);
+        void Set(size_t index, Coordinates coords);
+        void Clear();
+
+        template <typename Function>
+        void Visit(Function&& function) const;
+
+    private:
+        static bool IsInFixedPointRange(double degrees);
+        static int32_t ToFixedPoint(double degrees);
+
+        CoordinatesEncoding encoding_;
+        std::vector<double> lats_;
+        std::vector<double> lngs_;
+        std::vector<int32_t> fixed_lats_;
+        std::vector<int32_t> fixed_lngs_;
+    };
+
+    template <std::forward_iterator CoordinatesIt>
+    CoordinatesArray::CoordinatesArray(CoordinatesIt points_begin, CoordinatesIt points_end, CoordinatesEncoding encoding)
+    : encoding_(encoding) {
+        Reserve(static_cast<size_t>(std::distance(points_begin, points_end)));
+        for (auto it = points_begin; it != points_end; ++it) {
+            PushBack(*it);
+        }
+    }
+
+    template <typename Function>
+    void CoordinatesArray::Visit(Function&& function) const {
+        if (encoding_ == CoordinatesEncoding::FixedPoint) {
+            function(fixed_lats_, fixed_lngs_, FIXED_POINT_UNITS);
+        } else {
+            function(lats_, lngs_, 1.0);
+        }
+    }
+
+    enum class DistanceMode {
+        Exact,
+        Approximate
+    };
+
+    class DistanceTable {
+    public:
+        DistanceTable() = default;
+        explicit DistanceTable(const std::vector<Coordinates>& points, DistanceMode mode = DistanceMode::Exact);
+        explicit DistanceTable(const CoordinatesArray& points, DistanceMode mode = DistanceMode::Exact);
+
+        DistanceMode GetMode() const;
+        double GetRelativeErrorBound() const;
+        size_t GetPointsCount() const;
+        double ComputeDistance(uint32_t from, uint32_t to) const;
+        void ComputeDistances(uint32_t from, const uint32_t* to, double* distances, size_t count) const;
+        void ComputeDistances(const uint32_t* from, const uint32_t* to, double* distances, size_t count) const;
+        double ComputePathLength() const;
+
+        void PushBack(Coordinates coords);
+        void Set(size_t index, Coordinates coords);
+
+    private:
+        static double ChordToDistance(double squared_chord);
+        void ProjectOnSphere(size_t index, double lat, double lng);
+        void ProjectEquirectangular(const CoordinatesArray& points);
+        double ToDistance(double squared_chord) const;
+        void ComputeBatch(const uint32_t* from, size_t from_step, const uint32_t* to, double* distances, size_t count) const;
+
+        DistanceMode mode_ = DistanceMode::Exact;
+        double relative_error_bound_ = 0.0;
+        std::vector<double> x_;
+        std::vector<double> y_;
+        std::vector<double> z_;
+    };
+
     class SphereProjector {
     public:
         template <std::forward_iterator CoordinatesIt>
         SphereProjector(CoordinatesIt points_begin, CoordinatesIt points_end,
                         double max_width, double max_height, double padding);
+        SphereProjector(const CoordinatesArray& points, double max_width, double max_height, double padding);
 
         svg::Point RescaleCoordinates(Coordinates coords) const;
+        void RescaleCoordinates(const CoordinatesArray& points, std::vector<svg::Point>& result) const;
 
     private:
         double padding_ = 0.0;
@@ -103,44 +201,7 @@ namespace Geo {
     template <std::forward_iterator CoordinatesIt>
     inline SphereProjector::SphereProjector(CoordinatesIt points_begin, CoordinatesIt points_end,
         double max_width, double max_height, double padding)
-    : padding_(padding) {
-
-    if (points_begin == points_end) {
-        return;
+    : SphereProjector(CoordinatesArray(points_begin, points_end), max_width, max_height, padding) {
     }
 
-    const auto [left_it, right_it] = std::minmax_element(
-    points_begin, points_end,
-    [](auto lhs, auto rhs) { return lhs.lng < rhs.lng; });
-
-    min_lon_ = left_it->lng;
-    const double max_lon = right_it->lng;
-
-    const auto [bottom_it, top_it] = std::minmax_element(
-    points_begin, points_end,
-    [](auto lhs, auto rhs) { return lhs.lat < rhs.lat; });
-
-    const double min_lat = bottom_it->lat;
-    max_lat_ = top_it->lat;
-
-    std::optional<double> width_zoom;
-    if (!IsZero(max_lon - min_lon_)) {
-        width_zoom = (max_width - 2 * padding) / (max_lon - min_lon_);
-    }
-
-    std::optional<double> height_zoom;
-    if (!IsZero(max_lat_ - min_lat)) {
-        height_zoom = (max_height - 2 * padding) / (max_lat_ - min_lat);
-    }
-
-    if (width_zoom && height_zoom) {
-        zoom_coeff_ = std::min(*width_zoom, *height_zoom);
-    } else if (width_zoom) {
-        zoom_coeff_ = *width_zoom;
-    } else if (height_zoom) {
-        zoom_coeff_ = *height_zoom;
-    }
-
-}
-
 }
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace graph {
+
+using VertexId = size_t;
+using EdgeId = size_t;
+
+template <typename Weight>
+struct Edge {
+    VertexId from_;
+    VertexId to_;
+    Weight weight_;
+};
+
+template <typename Weight>
+class DirectedWeightedGraph {
+public:
+    DirectedWeightedGraph() = default;
+    explicit DirectedWeightedGraph(size_t vertex_count);
+
+    EdgeId AddEdge(const Edge<Weight>& edge);
+
+    size_t GetVertexCount() const;
+    size_t GetEdgeCount() const;
+    const Edge<Weight>& GetEdge(EdgeId edge_id) const;
+    std::span<const EdgeId> GetIncidentEdges(VertexId vertex) const;
+
+private:
+    std::vector<Edge<Weight>> edges_;
+    std::vector<std::vector<EdgeId>> incidence_lists_;
+};
+
+template <typename Weight>
+DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
+    : incidence_lists_(vertex_count) {}
+
+template <typename Weight>
+EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
+    if (edge.from_ >= incidence_lists_.size() || edge.to_ >= incidence_lists_.size()) {
+        throw std::out_of_range("The edge vertex is out of the graph");
+    }
+    edges_.push_back(edge);
+    const EdgeId id = edges_.size() - 1;
+    incidence_lists_[edge.from_].push_back(id);
+    return id;
+}
+
+template <typename Weight>
+size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
+    return incidence_lists_.size();
+}
+
+template <typename Weight>
+size_t DirectedWeightedGraph<Weight>::GetEdgeCount() const {
+    return edges_.size();
+}
+
+template <typename Weight>
+const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
+    return edges_.at(edge_id);
+}
+
+template <typename Weight>
+std::span<const EdgeId> DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
+    return incidence_lists_.at(vertex);
+}
+
+}
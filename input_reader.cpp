@@ -166,6 +166,7 @@ void InputReader::ApplyCommands([[maybe_unused]] TransportCatalogue& catalogue)
     for (auto& bus : buses) {
         catalogue.AddBus(string(bus.first), bus.second);
     }
+    catalogue.ReorderStopsAlongHilbertCurve();
 }
 
 void ReadInputAndApply(std::istream& in, TransportCatalogue& catalogue) {
@@ -1,4 +1,5 @@
 #include "json_reader.h"
+#include <sstream>
 
 using namespace std;
 
@@ -42,30 +43,216 @@ void JsonReader::ReadStatJsonRequests(const json::Document& doc, RequestHander&
     auto& result = doc.GetRoot().AsMap().at("stat_requests").AsArray();
 
     for (const auto& stat_request : result) {
-        Stat request_format;
-        request_format.id_ = stat_request.AsMap().at("id"s).AsInt();
+        handler.AddRequest(ReadStatJsonRequest(stat_request));
+    }
+}
 
-        auto name_it = stat_request.AsMap().find("name"s);
-        if (name_it != stat_request.AsMap().end()) {
-            request_format.name_ = name_it->second.AsString();
-        }
+Stat JsonReader::ReadStatJsonRequest(const json::Node& stat_request) {
+    Stat request_format;
+    request_format.id_ = stat_request.AsMap().at("id"s).AsInt();
 
-        auto& type_request = stat_request.AsMap().at("type"s).AsString();
-        
-        if (type_request == "Stop"s) {
-            request_format.type_ = RequestType::Stop;
-        }
+    auto name_it = stat_request.AsMap().find("name"s);
+    if (name_it != stat_request.AsMap().end()) {
+        request_format.name_ = name_it->second.AsString();
+    }
+
+    auto from_it = stat_request.AsMap().find("from"s);
+    if (from_it != stat_request.AsMap().end()) {
+        request_format.from_ = from_it->second.AsString();
+    }
+
+    auto to_it = stat_request.AsMap().find("to"s);
+    if (to_it != stat_request.AsMap().end()) {
+        request_format.to_ = to_it->second.AsString();
+    }
+
+    auto time_it = stat_request.AsMap().find("max_time"s);
+    if (time_it != stat_request.AsMap().end()) {
+        request_format.time_limit_ = time_it->second.AsDouble();
+    }
+
+    auto departure_it = stat_request.AsMap().find("departure_time"s);
+    if (departure_it != stat_request.AsMap().end()) {
+        request_format.departure_time_ = departure_it->second.AsDouble();
+    }
+
+    auto latitude_it = stat_request.AsMap().find("latitude"s);
+    auto longitude_it = stat_request.AsMap().find("longitude"s);
+    if (latitude_it != stat_request.AsMap().end() && longitude_it != stat_request.AsMap().end()) {
+        request_format.coords_ = {latitude_it->second.AsDouble(), longitude_it->second.AsDouble()};
+    }
+
+    auto count_it = stat_request.AsMap().find("count"s);
+    if (count_it != stat_request.AsMap().end()) {
+        request_format.count_ = static_cast<size_t>(max(count_it->second.AsInt(), 0));
+    }
+
+    auto radius_it = stat_request.AsMap().find("radius"s);
+    if (radius_it != stat_request.AsMap().end()) {
+        request_format.radius_ = radius_it->second.AsDouble();
+    }
+
+    auto render_it = stat_request.AsMap().find("render"s);
+    if (render_it != stat_request.AsMap().end()) {
+        request_format.render_ = render_it->second.AsBool();
+    }
 
-        else if (type_request == "Bus"s) {
-            request_format.type_ = RequestType::Bus;
+    auto& type_request = stat_request.AsMap().at("type"s).AsString();
+    
+    if (type_request == "Stop"s) {
+        request_format.type_ = RequestType::Stop;
+    }
+
+    else if (type_request == "Bus"s) {
+        request_format.type_ = RequestType::Bus;
+    }
+
+    else if (type_request == "Map"s) {
+        request_format.type_ = RequestType::Map;
+    }
+
+    else if (type_request == "Route"s) {
+        request_format.type_ = RequestType::Route;
+    }
+
+    else if (type_request == "Isochrone"s) {
+        request_format.type_ = RequestType::Isochrone;
+    }
+
+    else if (type_request == "Journey"s) {
+        request_format.type_ = RequestType::Journey;
+    }
+
+    else if (type_request == "NearestStops"s) {
+        request_format.type_ = RequestType::NearestStops;
+    }
+
+    else if (type_request == "StopsInRadius"s) {
+        request_format.type_ = RequestType::StopsInRadius;
+    }
+
+    else if (type_request == "BusesNearby"s) {
+        request_format.type_ = RequestType::BusesNearby;
+    }
+
+    return request_format;
+}
+
+shared_ptr<const StatJsonLine> JsonReader::ReadStatJsonLine(const string& line) {
+    auto request = make_shared<StatJsonLine>();
+    try {
+        istringstream line_stream(line);
+        request->doc_.emplace(json::Load(line_stream));
+        request->stat_ = ReadStatJsonRequest(request->doc_->GetRoot());
+    } catch (const exception& e) {
+        request->error_ = e.what();
+    }
+    return request;
+}
+
+CatalogueChange JsonReader::ReadChangeJson(const json::Node& change_request) {
+    const json::Dict& request = change_request.AsMap();
+    const string& type = request.at("type"s).AsString();
+    CatalogueChange change;
+
+    if (type == "RemoveBus"s) {
+        change.type_ = ChangeType::RemoveBus;
+        change.name_ = request.at("name"s).AsString();
+    }
+    else if (type == "UpdateBusRoute"s) {
+        change.type_ = ChangeType::UpdateBusRoute;
+        change.name_ = request.at("name"s).AsString();
+        change.is_round_ = request.at("is_roundtrip"s).AsBool();
+        for (const auto& stop_node : request.at("stops"s).AsArray()) {
+            change.route_.push_back(stop_node.AsString());
+        }
+        if (change.route_.empty()) {
+            throw invalid_argument("Empty route for bus: "s + change.name_);
         }
+        if (!change.is_round_ && change.route_.size() > 1) {
+            for (int64_t i = static_cast<int64_t>(change.route_.size()) - 2; i >= 0; i--) {
+                change.route_.push_back(change.route_[i]);
+            }
+        }
+    }
+    else if (type == "MoveStop"s) {
+        change.type_ = ChangeType::MoveStop;
+        change.name_ = request.at("name"s).AsString();
+        change.coords_ = Geo::Coordinates(request.at("latitude"s).AsDouble(), request.at("longitude"s).AsDouble());
+    }
+    else if (type == "UpdateDistance"s) {
+        change.type_ = ChangeType::UpdateDistance;
+        change.name_ = request.at("from"s).AsString();
+        change.other_name_ = request.at("to"s).AsString();
+        change.distance_ = static_cast<uint32_t>(request.at("distance"s).AsInt());
+    }
+    else {
+        throw invalid_argument("Unknown change type: "s + type);
+    }
 
-        else if (type_request == "Map"s) {
-            request_format.type_ = RequestType::Map;
+    return change;
+}
+
+RoutingSettings JsonReader::ReadRoutingSettingsJson(const json::Document& doc) {
+    const json::Dict& settings = doc.GetRoot().AsMap().at("routing_settings"s).AsMap();
+    RoutingSettings result{settings.at("bus_wait_time"s).AsDouble(), settings.at("bus_velocity"s).AsDouble()};
+    if (auto landmarks_it = settings.find("landmarks_count"s); landmarks_it != settings.end()) {
+        result.landmarks_count_ = static_cast<size_t>(landmarks_it->second.AsInt());
+    }
+    if (auto mode_it = settings.find("distance_mode"s); mode_it != settings.end()) {
+        const string& mode = mode_it->second.AsString();
+        if (mode == "approximate"s) {
+            result.distance_mode_ = Geo::DistanceMode::Approximate;
+        } else if (mode != "exact"s) {
+            throw invalid_argument("Unknown distance mode: "s + mode);
         }
+    }
+    return result;
+}
 
-        handler.AddRequest(move(request_format));
+Geo::CoordinatesEncoding JsonReader::ReadCoordinatesEncodingJson(const json::Document& doc) {
+    const json::Dict& root = doc.GetRoot().AsMap();
+    auto settings_it = root.find("catalogue_settings"s);
+    if (settings_it == root.end()) {
+        return Geo::CoordinatesEncoding::Double;
+    }
+    const json::Dict& settings = settings_it->second.AsMap();
+    auto encoding_it = settings.find("coordinates_encoding"s);
+    if (encoding_it == settings.end()) {
+        return Geo::CoordinatesEncoding::Double;
     }
+    const string& encoding = encoding_it->second.AsString();
+    if (encoding == "fixed_point"s) {
+        return Geo::CoordinatesEncoding::FixedPoint;
+    } else if (encoding != "double"s) {
+        throw invalid_argument("Unknown coordinates encoding: "s + encoding);
+    }
+    return Geo::CoordinatesEncoding::Double;
+}
+
+vector<BusSchedule> JsonReader::ReadSchedulesJson(const json::Node& schedules) {
+    vector<BusSchedule> result;
+    for (const json::Node& schedule_node : schedules.AsArray()) {
+        const json::Dict& schedule = schedule_node.AsMap();
+        BusSchedule bus_schedule{schedule.at("bus"s).AsString(), {}};
+        if (auto departures_it = schedule.find("departures"s); departures_it != schedule.end()) {
+            for (const json::Node& departure : departures_it->second.AsArray()) {
+                bus_schedule.departures_.push_back(departure.AsDouble());
+            }
+        } else {
+            const double last_departure = schedule.at("last_departure"s).AsDouble();
+            const double interval = schedule.at("interval"s).AsDouble();
+            if (interval <= 0.0) {
+                throw invalid_argument("Schedule interval must be positive: "s + bus_schedule.bus_);
+            }
+            for (double departure = schedule.at("first_departure"s).AsDouble(); departure <= last_departure;
+                departure += interval) {
+                bus_schedule.departures_.push_back(departure);
+            }
+        }
+        result.push_back(move(bus_schedule));
+    }
+    return result;
 }
 
 void JsonReader::ReadRenderSettingsJson(const json::Document& doc, map_renderer::MapRenderer& route_map) {
@@ -91,65 +278,148 @@ void JsonReader::ReadRenderSettingsJson(const json::Document& doc, map_renderer:
     }
 }
 
-json::Document JsonReader::BuildStatJsonOutput(const std::vector<std::shared_ptr<Stat>>& answers) {
-    json::Array arr;
+namespace {
 
-    for (auto& answer : answers) {
-        json::Dict stat;
-        stat["request_id"s] = answer->id_;
+struct StatBodyWriter {
+    ostream& out_;
 
-        switch (answer->type_) {
-        case RequestType::Bus: {
-            StatBus* ptr_stat = dynamic_cast<StatBus*>(answer.get());
-            if (ptr_stat == nullptr) {
-                throw logic_error("Dynamic cust to StatBus is failed"s);
-            }
-            stat["curvature"s] = ptr_stat->curvature_;
-            stat["route_length"s] = ptr_stat->route_length_;
-            stat["stop_count"s] = ptr_stat->stops_count_;
-            stat["unique_stop_count"s] = ptr_stat->unique_stops_count_;
-            arr.push_back(move(stat));
-            break;
-        }  
-        case RequestType::Stop: {
-            StatStop* ptr_stat = dynamic_cast<StatStop*>(answer.get());
-            if (ptr_stat == nullptr) {
-                throw logic_error("Dynamic cust to StatStop is failed"s);
-            }
-            json::Array buses;
-            if (ptr_stat->buses_ != nullptr) {
-                for (auto& bus : *ptr_stat->buses_) {
-                    buses.emplace_back(bus->name_);
-                }
-            }
-            stat["buses"s] = move(buses);
-            arr.push_back(move(stat));
-            break;
+    void operator() (const StatError&) const {
+        out_ << "\"error_message\" : \"not found\"}";
+    }
+
+    void operator() (const StatBus& answer) const {
+        WriteBusFragment(answer, out_);
+    }
+
+    void operator() (const StatStop& answer) const {
+        WriteStopFragment(answer.buses_, out_);
+    }
+
+    void operator() (const StatMap& answer) const {
+        ostringstream svg_map;
+        answer.map_.Render(svg_map);
+        out_ << "\"map\" : ";
+        json::NodePrinter{out_}(svg_map.str());
+        out_ << '}';
+    }
+
+    void operator() (const StatRoute& answer) const {
+        WriteRouteFragment(answer, out_);
+    }
+
+    void operator() (const StatJourney& answer) const {
+        out_ << "\"arrival_time\" : ";
+        json::NodePrinter{out_}(answer.arrival_time_);
+        out_ << ", ";
+        WriteRouteFragment(answer, out_);
+    }
+
+    void operator() (const StatIsochrone& answer) const {
+        if (answer.map_) {
+            ostringstream svg_map;
+            answer.map_->Render(svg_map);
+            out_ << "\"map\" : ";
+            json::NodePrinter{out_}(svg_map.str());
+            out_ << ", ";
         }
-        case RequestType::Map: {
-            StatMap* ptr_stat = dynamic_cast<StatMap*>(answer.get());
-            if (ptr_stat == nullptr) {
-                throw logic_error("Dynamic cust to StatMap is failed"s);
-            }
-            
-            stringstream stream_str;
-            ptr_stat->map_.Render(stream_str);
-            string svg_map(stream_str.str());
+        WriteIsochroneFragment(answer.stops_, out_);
+    }
+
+    void operator() (const StatNearbyStops& answer) const {
+        WriteNearbyStopsFragment(answer.stops_, out_);
+    }
+
+    void operator() (const StatNearbyBuses& answer) const {
+        WriteNearbyBusesFragment(answer.buses_, out_);
+    }
+
+    void operator() (const StatFragment& answer) const {
+        out_ << *answer.fragment_;
+    }
+
+    void operator() (const StatDuplicate&) const {
+        throw logic_error("Duplicate answer is written without its origin"s);
+    }
+};
 
-            stat["map"] = move(svg_map);
-            arr.push_back(move(stat));
-            break;
+}
+
+json::Document JsonReader::BuildStatJsonOutput(const std::vector<StatAnswer>& answers) {
+    stringstream output;
+    WriteStatJsonOutput(answers, output);
+    return json::Load(output);
+}
+
+void JsonReader::WriteStatJsonOutput(const std::vector<StatAnswer>& answers, std::ostream& out) {
+    vector<string> bodies(answers.size());
+    out << "[\n";
+
+    for (size_t i = 0; i < answers.size(); ++i) {
+        const StatAnswer& answer = answers[i];
+        size_t origin = i;
+        if (const StatDuplicate* duplicate = get_if<StatDuplicate>(&answer)) {
+            origin = duplicate->origin_;
         }
 
-        case RequestType::Error: {
-            stat["error_message"] = "not found"s;
-            arr.push_back(move(stat));
-            break;
+        if (i != 0) {
+            out << ",\n";
         }
+        out << "{\"request_id\" : " << visit([](const auto& value) { return value.id_; }, answer) << ", ";
+
+        if (const StatFragment* fragment = get_if<StatFragment>(&answers[origin])) {
+            out << *fragment->fragment_;
+            continue;
         }
+
+        if (bodies[origin].empty()) {
+            ostringstream body;
+            visit(StatBodyWriter{body}, answers[origin]);
+            bodies[origin] = body.str();
+        }
+        out << bodies[origin];
+    }
+
+    out << "\n]";
+}
+
+void JsonReader::WriteStatJsonAnswer(const StatAnswer& answer, std::ostream& out) {
+    out << "{\"request_id\" : " << visit([](const auto& value) { return value.id_; }, answer) << ", ";
+    visit(StatBodyWriter{out}, answer);
+}
+
+string JsonReader::AnswerStatJson(const StatJsonLine& request, const RequestHander& handler, 
+    const TransportCatalogue& transport_c, const optional<map_renderer::MapRenderer>& route_map) {
+    ostringstream answer;
+    if (!request.stat_) {
+        WriteStatJsonError(request.error_, answer);
+        return answer.str();
     }
+    try {
+        WriteStatJsonAnswer(handler.GetStat(transport_c, *request.stat_, route_map), answer);
+    } catch (const exception& e) {
+        answer.str(""s);
+        WriteStatJsonError(e.what(), answer);
+    }
+    return answer.str();
+}
+
+string JsonReader::AnswerStatJsonLine(const string& line, const RequestHander& handler, 
+    const TransportCatalogue& transport_c, const optional<map_renderer::MapRenderer>& route_map) {
+    return AnswerStatJson(*ReadStatJsonLine(line), handler, transport_c, route_map);
+}
+
+void JsonReader::AnswerStatJsonLines(istream& requests, ostream& out, const RequestHander& handler, 
+    const TransportCatalogue& transport_c, const optional<map_renderer::MapRenderer>& route_map) {
+    string line;
+    while (getline(requests, line)) {
+        out << AnswerStatJsonLine(line, handler, transport_c, route_map) << endl;
+    }
+}
 
-    return json::Document(json::Node(arr));
+void JsonReader::WriteStatJsonError(const string& message, ostream& out) {
+    out << "{\"error_message\" : ";
+    json::NodePrinter{out}(message);
+    out << '}';
 }
 
 svg::Color JsonReader::ReadColor(const json::Node& node) {
@@ -3,15 +3,37 @@
 #include "json.h"
 #include "request_handler.h"
 #include "map_renderer.h"
+#include "catalogue_store.h"
+
+struct StatJsonLine {
+    std::optional<json::Document> doc_;
+    std::optional<Stat> stat_;
+    std::string error_;
+};
 
 class JsonReader {
 public:
     JsonReader();
     void ReadBaseJsonRequests(const json::Document& doc, RequestHander& handler);
     void ReadStatJsonRequests(const json::Document& doc, RequestHander& handler);
+    Stat ReadStatJsonRequest(const json::Node& stat_request);
+    std::shared_ptr<const StatJsonLine> ReadStatJsonLine(const std::string& line);
+    CatalogueChange ReadChangeJson(const json::Node& change_request);
+    RoutingSettings ReadRoutingSettingsJson(const json::Document& doc);
+    Geo::CoordinatesEncoding ReadCoordinatesEncodingJson(const json::Document& doc);
+    std::vector<BusSchedule> ReadSchedulesJson(const json::Node& schedules);
     void ReadRenderSettingsJson(const json::Document& doc, map_renderer::MapRenderer& route_map);
-    json::Document BuildStatJsonOutput(const std::vector<std::shared_ptr<Stat>>& answers);
+    json::Document BuildStatJsonOutput(const std::vector<StatAnswer>& answers);
+    void WriteStatJsonOutput(const std::vector<StatAnswer>& answers, std::ostream& out);
+    void WriteStatJsonAnswer(const StatAnswer& answer, std::ostream& out);
+    std::string AnswerStatJson(const StatJsonLine& request, const RequestHander& handler, 
+        const TransportCatalogue& transport_c, const std::optional<map_renderer::MapRenderer>& route_map);
+    std::string AnswerStatJsonLine(const std::string& line, const RequestHander& handler, 
+        const TransportCatalogue& transport_c, const std::optional<map_renderer::MapRenderer>& route_map);
+    void AnswerStatJsonLines(std::istream& requests, std::ostream& out, const RequestHander& handler, 
+        const TransportCatalogue& transport_c, const std::optional<map_renderer::MapRenderer>& route_map);
 
 private:
+    void WriteStatJsonError(const std::string& message, std::ostream& out);
     svg::Color ReadColor(const json::Node& node);
 };
\ No newline at end of file
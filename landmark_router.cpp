@@ -0,0 +1,165 @@
+#include "landmark_router.h"
+#include <algorithm>
+#include <limits>
+#include <queue>
+
+using namespace std;
+
+namespace graph {
+
+namespace {
+
+const double INFINITE_WEIGHT = numeric_limits<double>::infinity();
+const EdgeId NO_EDGE = numeric_limits<EdgeId>::max();
+
+DirectedWeightedGraph<double> MakeReversedGraph(const DirectedWeightedGraph<double>& graph) {
+    DirectedWeightedGraph<double> reversed(graph.GetVertexCount());
+    for (EdgeId id = 0; id < graph.GetEdgeCount(); ++id) {
+        const Edge<double>& edge = graph.GetEdge(id);
+        reversed.AddEdge({edge.to_, edge.from_, edge.weight_});
+    }
+    return reversed;
+}
+
+}
+
+LandmarkRouter::LandmarkRouter(const Graph& graph, vector<VertexId> landmarks, ThreadPool& pool,
+    LowerBound lower_bound)
+    : graph_(graph)
+    , landmarks_(move(landmarks))
+    , lower_bound_(move(lower_bound)) {
+    const size_t vertex_count = graph_.GetVertexCount();
+    const size_t landmarks_count = landmarks_.size();
+    from_landmarks_.assign(vertex_count * landmarks_count, INFINITE_WEIGHT);
+    to_landmarks_.assign(vertex_count * landmarks_count, INFINITE_WEIGHT);
+
+    const Graph reversed = MakeReversedGraph(graph_);
+    const Router<double> forward_router(graph_);
+    const Router<double> backward_router(reversed);
+
+    pool.ParallelFor(landmarks_count * 2, [&](size_t task) {
+        const size_t landmark = task % landmarks_count;
+        const bool is_forward = task < landmarks_count;
+        const auto tree = (is_forward ? forward_router : backward_router).BuildTree(landmarks_[landmark]);
+        vector<double>& table = is_forward ? from_landmarks_ : to_landmarks_;
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            if (tree.weights_[vertex] != Router<double>::UNREACHABLE) {
+                table[vertex * landmarks_count + landmark] = tree.weights_[vertex];
+            }
+        }
+    });
+}
+
+optional<LandmarkRouter::RouteInfo> LandmarkRouter::BuildRoute(VertexId from, VertexId to, size_t* settled_count) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        return nullopt;
+    }
+
+    thread_local Scratch scratch;
+    scratch.Prepare(vertex_count);
+    vector<double>& weights = scratch.weights_;
+    vector<double>& potentials = scratch.potentials_;
+    vector<EdgeId>& prev_edges = scratch.prev_edges_;
+    auto potential = [&](VertexId vertex) {
+        if (potentials[vertex] < 0.0) {
+            potentials[vertex] = ComputePotential(vertex, to);
+            scratch.touched_.push_back(vertex);
+        }
+        return potentials[vertex];
+    };
+
+    using QueueItem = pair<double, VertexId>;
+    priority_queue<QueueItem, vector<QueueItem>, greater<QueueItem>> queue;
+    weights[from] = 0.0;
+    queue.push({potential(from), from});
+
+    size_t settled = 0;
+    while (!queue.empty()) {
+        auto [key, vertex] = queue.top();
+        queue.pop();
+        if (key > weights[vertex] + potentials[vertex]) {
+            continue;
+        }
+        ++settled;
+        if (vertex == to) {
+            break;
+        }
+        for (EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const Edge<double>& edge = graph_.GetEdge(edge_id);
+            const double new_weight = weights[vertex] + edge.weight_;
+            if (new_weight >= weights[edge.to_]) {
+                continue;
+            }
+            const double edge_potential = potential(edge.to_);
+            if (edge_potential == INFINITE_WEIGHT) {
+                continue;
+            }
+            weights[edge.to_] = new_weight;
+            prev_edges[edge.to_] = edge_id;
+            queue.push({new_weight + edge_potential, edge.to_});
+        }
+    }
+    if (settled_count != nullptr) {
+        *settled_count = settled;
+    }
+
+    optional<RouteInfo> result;
+    if (weights[to] != INFINITE_WEIGHT) {
+        RouteInfo& route = result.emplace(RouteInfo{weights[to], {}});
+        for (VertexId vertex = to; vertex != from; vertex = graph_.GetEdge(prev_edges[vertex]).from_) {
+            route.edges_.push_back(prev_edges[vertex]);
+        }
+        reverse(route.edges_.begin(), route.edges_.end());
+    }
+    scratch.Reset();
+    return result;
+}
+
+const vector<VertexId>& LandmarkRouter::GetLandmarks() const {
+    return landmarks_;
+}
+
+void LandmarkRouter::Scratch::Prepare(size_t vertex_count) {
+    if (weights_.size() < vertex_count) {
+        weights_.resize(vertex_count, INFINITE_WEIGHT);
+        potentials_.resize(vertex_count, -1.0);
+        prev_edges_.resize(vertex_count, NO_EDGE);
+    }
+}
+
+void LandmarkRouter::Scratch::Reset() {
+    for (VertexId vertex : touched_) {
+        weights_[vertex] = INFINITE_WEIGHT;
+        potentials_[vertex] = -1.0;
+        prev_edges_[vertex] = NO_EDGE;
+    }
+    touched_.clear();
+}
+
+double LandmarkRouter::ComputePotential(VertexId vertex, VertexId to) const {
+    double bound = lower_bound_ ? lower_bound_(vertex, to) : 0.0;
+    const size_t landmarks_count = landmarks_.size();
+    const double* from_vertex = from_landmarks_.data() + vertex * landmarks_count;
+    const double* from_target = from_landmarks_.data() + to * landmarks_count;
+    const double* to_vertex = to_landmarks_.data() + vertex * landmarks_count;
+    const double* to_target = to_landmarks_.data() + to * landmarks_count;
+
+    for (size_t i = 0; i < landmarks_count; ++i) {
+        if (from_vertex[i] != INFINITE_WEIGHT) {
+            if (from_target[i] == INFINITE_WEIGHT) {
+                return INFINITE_WEIGHT;
+            }
+            bound = max(bound, from_target[i] - from_vertex[i]);
+        }
+        if (to_target[i] != INFINITE_WEIGHT) {
+            if (to_vertex[i] == INFINITE_WEIGHT) {
+                return INFINITE_WEIGHT;
+            }
+            bound = max(bound, to_vertex[i] - to_target[i]);
+        }
+    }
+    return bound;
+}
+
+}
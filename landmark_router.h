@@ -0,0 +1,46 @@
+#pragma once
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "graph.h"
+#include "router.h"
+#include "thread_pool.h"
+
+namespace graph {
+
+class LandmarkRouter {
+public:
+    using Graph = DirectedWeightedGraph<double>;
+    using RouteInfo = Router<double>::RouteInfo;
+    using LowerBound = std::function<double(VertexId from, VertexId to)>;
+
+    LandmarkRouter(const Graph& graph, std::vector<VertexId> landmarks, ThreadPool& pool,
+        LowerBound lower_bound = nullptr);
+    LandmarkRouter(const LandmarkRouter&) = delete;
+    LandmarkRouter& operator=(const LandmarkRouter&) = delete;
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to, size_t* settled_count = nullptr) const;
+    const std::vector<VertexId>& GetLandmarks() const;
+
+private:
+    struct Scratch {
+        std::vector<double> weights_;
+        std::vector<double> potentials_;
+        std::vector<EdgeId> prev_edges_;
+        std::vector<VertexId> touched_;
+
+        void Prepare(size_t vertex_count);
+        void Reset();
+    };
+
+    double ComputePotential(VertexId vertex, VertexId to) const;
+
+    const Graph& graph_;
+    std::vector<VertexId> landmarks_;
+    LowerBound lower_bound_;
+    std::vector<double> from_landmarks_;
+    std::vector<double> to_landmarks_;
+};
+
+}
@@ -3,13 +3,33 @@
 #ifdef RELEASE
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#ifdef __linux__
+#include <csignal>
+#include <pthread.h>
+#endif
 
 #include "request_handler.h"
 #include "json.h"
 #include "json_reader.h"
+#include "catalogue_snapshot.h"
+#include "catalogue_store.h"
+#include "query_server.h"
+#include "query_client.h"
+#include "binary_io.h"
 
 using namespace std;
 
+const size_t HEAVY_THREADS = max<size_t>(1, thread::hardware_concurrency() / 4);
+const size_t LIGHT_THREADS = max<size_t>(HEAVY_THREADS + 1, thread::hardware_concurrency()) - HEAVY_THREADS;
+const size_t CHECKPOINT_INTERVAL = 1000;
+const size_t MATRIX_ROWS_PER_BATCH = 256;
+const size_t ROUTE_CACHE_CAPACITY = 100000;
+const uint32_t MATRIX_MAGIC = 0x584D4354;
+const uint32_t MATRIX_FORMAT = 1;
+
 void ReadAndWriteRequest(istream& input, ostream& out) {
     json::Document parsed_doc = json::Load(input);
 
@@ -18,20 +38,39 @@ void ReadAndWriteRequest(istream& input, ostream& out) {
     reader.ReadBaseJsonRequests(parsed_doc, handler);
     reader.ReadStatJsonRequests(parsed_doc, handler);
 
-    TransportCatalogue transfport_catalogue;
+    TransportCatalogue transfport_catalogue(reader.ReadCoordinatesEncodingJson(parsed_doc));
     handler.ProvideInputRequests(transfport_catalogue);
     
-    MapRenderer::MapRenderer route_map;
+    map_renderer::MapRenderer route_map;
     reader.ReadRenderSettingsJson(parsed_doc, route_map);
     for (auto& bus_ptr : transfport_catalogue.GetAllBuses()) {
         route_map.AddRoute(bus_ptr);
     }
     route_map.ReorderRouteColors();
-    
-    auto stats = handler.GetStats(transfport_catalogue, route_map);
-    json::Document out_doc = reader.BuildStatJsonOutput(stats);
+    route_map.UpdateLayout();
 
-    json::PrintNode(out_doc, out);
+    StopsIndex stops_index(transfport_catalogue.GetAllStops());
+    handler.SetStopsIndex(&stops_index);
+    SegmentsIndex segments_index(transfport_catalogue.GetAllBuses());
+    handler.SetSegmentsIndex(&segments_index);
+    StatFragments fragments(transfport_catalogue);
+    handler.SetStatFragments(&fragments);
+
+    StatScheduler scheduler(LIGHT_THREADS, HEAVY_THREADS);
+    optional<TransportRouter> router;
+    optional<Timetable> timetable;
+    if (parsed_doc.GetRoot().AsMap().contains("routing_settings"s)) {
+        RoutingSettings settings = reader.ReadRoutingSettingsJson(parsed_doc);
+        router.emplace(transfport_catalogue, settings, scheduler.GetHeavyPool());
+        handler.SetRouter(&*router);
+        if (auto schedules_it = parsed_doc.GetRoot().AsMap().find("schedules"s); schedules_it != parsed_doc.GetRoot().AsMap().end()) {
+            timetable.emplace(transfport_catalogue, settings, reader.ReadSchedulesJson(schedules_it->second));
+            handler.SetTimetable(&*timetable);
+        }
+    }
+    
+    auto stats = handler.GetStatsParallel(transfport_catalogue, scheduler, route_map);
+    reader.WriteStatJsonOutput(stats, out);
 }
 
 void ReadAndRenderMap(istream& in, ostream& out) {
@@ -41,23 +80,261 @@ void ReadAndRenderMap(istream& in, ostream& out) {
     JsonReader reader;
     reader.ReadBaseJsonRequests(parsed_doc, handler);
 
-    MapRenderer::MapRenderer route_map;
+    map_renderer::MapRenderer route_map;
     reader.ReadRenderSettingsJson(parsed_doc, route_map);
 
-    TransportCatalogue transfport_catalogue;
+    TransportCatalogue transfport_catalogue(reader.ReadCoordinatesEncodingJson(parsed_doc));
     handler.ProvideInputRequests(transfport_catalogue);
 
     for (auto& bus_ptr : transfport_catalogue.GetAllBuses()) {
         route_map.AddRoute(bus_ptr);
     }
     route_map.ReorderRouteColors();
+    route_map.UpdateLayout();
 
     svg::Document doc_draw;
     route_map.Draw(doc_draw);
     doc_draw.Render(out);
 }
 
-int main() {
+void ServeJsonLines(istream& base_input, istream& requests, ostream& out) {
+    const CatalogueSnapshot snapshot(json::Load(base_input));
+
+    JsonReader reader;
+    reader.AnswerStatJsonLines(requests, out, snapshot.handler_, snapshot.transport_c_, snapshot.route_map_);
+}
+
+unique_ptr<CatalogueSnapshot> OpenStore(CatalogueStore& store, const string& base_path) {
+    if (store.HasCheckpoint()) {
+        return store.Open();
+    }
+    ifstream base_input(base_path);
+    if (!base_input) {
+        throw runtime_error("Cannot open base requests file: "s + base_path);
+    }
+    auto snapshot = make_unique<CatalogueSnapshot>(json::Load(base_input));
+    store.MakeCheckpoint(*snapshot);
+    return snapshot;
+}
+
+void UpdateCatalogue(const string& base_path, const string& store_dir, istream& changes, ostream& out) {
+    CatalogueStore store(store_dir);
+    unique_ptr<CatalogueSnapshot> snapshot = OpenStore(store, base_path);
+
+    JsonReader reader;
+    string line;
+    while (getline(changes, line)) {
+        if (line.find_first_not_of(" \t\r"s) == string::npos) {
+            continue;
+        }
+        try {
+            istringstream line_stream(line);
+            store.Apply(*snapshot, reader.ReadChangeJson(json::Load(line_stream).GetRoot()));
+            out << "{\"applied\" : true}"s << endl;
+        } catch (const exception& e) {
+            out << "{\"error_message\" : ";
+            json::NodePrinter{out}(string(e.what()));
+            out << '}' << endl;
+        }
+        if (store.GetLogTailSize() >= CHECKPOINT_INTERVAL) {
+            store.MakeCheckpoint(*snapshot);
+        }
+    }
+    store.MakeCheckpoint(*snapshot);
+}
+
+void PrepareRoutes(const string& base_path, const string& store_dir) {
+    CatalogueStore store(store_dir);
+    unique_ptr<CatalogueSnapshot> snapshot = OpenStore(store, base_path);
+    store.SaveHierarchy(*snapshot);
+}
+
+vector<string_view> ReadStopNames(const json::Dict& request, const string& key) {
+    vector<string_view> names;
+    for (const json::Node& node : request.at(key).AsArray()) {
+        names.push_back(node.AsString());
+    }
+    return names;
+}
+
+void WriteJsonNames(const vector<string_view>& names, ostream& out) {
+    out << '[';
+    for (size_t i = 0; i < names.size(); ++i) {
+        out << (i == 0 ? ""s : ", "s);
+        json::NodePrinter{out}(string(names[i]));
+    }
+    out << ']';
+}
+
+void WriteJsonMatrixRow(const TravelMatrix& matrix, size_t row, ostream& out) {
+    out << "{\"times\" : [";
+    for (size_t column = 0; column < matrix.columns_count_; ++column) {
+        out << (column == 0 ? ""s : ", "s);
+        if (matrix.HasRoute(row, column)) {
+            json::NodePrinter{out}(matrix.GetTime(row, column));
+        } else {
+            json::NodePrinter{out}(nullptr);
+        }
+    }
+    out << "], \"distances\" : [";
+    for (size_t column = 0; column < matrix.columns_count_; ++column) {
+        out << (column == 0 ? ""s : ", "s);
+        if (matrix.HasRoute(row, column)) {
+            json::NodePrinter{out}(matrix.GetDistance(row, column));
+        } else {
+            json::NodePrinter{out}(nullptr);
+        }
+    }
+    out << "]}";
+}
+
+void WriteBinaryMatrixRow(const TravelMatrix& matrix, size_t row, ostream& out) {
+    const size_t offset = row * matrix.columns_count_;
+    out.write(reinterpret_cast<const char*>(matrix.times_.data() + offset), matrix.columns_count_ * sizeof(double));
+    out.write(reinterpret_cast<const char*>(matrix.distances_.data() + offset), matrix.columns_count_ * sizeof(double));
+}
+
+void BuildTravelMatrix(const string& base_path, istream& request_input, ostream& out, bool is_binary) {
+    ifstream base_input(base_path);
+    const CatalogueSnapshot snapshot(json::Load(base_input));
+    if (!snapshot.router_) {
+        throw invalid_argument("The base has no routing_settings"s);
+    }
+    const TransportRouter& router = *snapshot.router_;
+
+    const json::Document request_doc = json::Load(request_input);
+    const json::Dict& request = request_doc.GetRoot().AsMap();
+    const vector<string_view> origins = ReadStopNames(request, "origins"s);
+    const vector<string_view> destinations = request.contains("destinations"s)
+        ? ReadStopNames(request, "destinations"s) : origins;
+    for (const auto* names : {&origins, &destinations}) {
+        for (string_view name : *names) {
+            if (!router.HasStop(name)) {
+                throw invalid_argument("Unknown stop: "s + string(name));
+            }
+        }
+    }
+
+    if (is_binary) {
+        binary_io::WriteValue<uint32_t>(out, MATRIX_MAGIC);
+        binary_io::WriteValue<uint32_t>(out, MATRIX_FORMAT);
+        binary_io::WriteValue<uint64_t>(out, origins.size());
+        binary_io::WriteValue<uint64_t>(out, destinations.size());
+    } else {
+        out << "{\"origins\" : ";
+        WriteJsonNames(origins, out);
+        out << ", \"destinations\" : ";
+        WriteJsonNames(destinations, out);
+        out << ", \"rows\" : [";
+    }
+
+    ThreadPool& pool = ThreadPool::GetShared();
+    for (size_t begin = 0; begin < origins.size(); begin += MATRIX_ROWS_PER_BATCH) {
+        const size_t end = min(origins.size(), begin + MATRIX_ROWS_PER_BATCH);
+        const TravelMatrix matrix = router.BuildMatrix({origins.begin() + begin, origins.begin() + end}, destinations, pool);
+        for (size_t row = 0; row < matrix.GetRowsCount(); ++row) {
+            if (is_binary) {
+                WriteBinaryMatrixRow(matrix, row, out);
+            } else {
+                out << (begin + row == 0 ? "\n"s : ",\n"s);
+                WriteJsonMatrixRow(matrix, row, out);
+            }
+        }
+        out.flush();
+    }
+
+    if (!is_binary) {
+        out << "\n]}" << endl;
+    }
+}
+
+#ifdef __linux__
+void WatchReloadSignal(SnapshotHolder& snapshots, const string& base_path, const optional<string>& store_dir,
+    const RouteCache& route_cache) {
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    thread([&snapshots, base_path, store_dir, signals, &route_cache] {
+        int signal = 0;
+        while (sigwait(&signals, &signal) == 0) {
+            RouteCacheStatistics statistics = route_cache.GetStatistics();
+            cerr << "Route cache: "s << statistics.hits_ << " hits, "s << statistics.misses_ << " misses, "s
+                << statistics.size_ << " entries"s << endl;
+            if (store_dir) {
+                snapshots.ReloadAsync([store_dir](uint64_t version) { return CatalogueStore(*store_dir).Read(version); });
+            } else {
+                snapshots.ReloadAsync(base_path);
+            }
+        }
+    }).detach();
+}
+
+void ServeSocket(const string& base_path, const string& socket_path, const optional<string>& store_dir) {
+    RouteCache route_cache(ROUTE_CACHE_CAPACITY);
+    SnapshotHolder snapshots;
+    snapshots.SetRouteCache(&route_cache);
+    if (store_dir) {
+        CatalogueStore store(*store_dir);
+        snapshots.Publish(OpenStore(store, base_path));
+    } else {
+        ifstream base_input(base_path);
+        snapshots.Reload(base_input);
+    }
+    WatchReloadSignal(snapshots, base_path, store_dir, route_cache);
+
+    StatScheduler scheduler(LIGHT_THREADS, HEAVY_THREADS);
+    QueryServer server(snapshots, scheduler);
+    server.Listen(socket_path);
+    server.Run();
+}
+
+void RunLoad(const string& socket_path, istream& requests_input, size_t connections, size_t repeat) {
+    vector<string> requests;
+    string line;
+    while (getline(requests_input, line)) {
+        if (line.find_first_not_of(" \t\r"s) != string::npos) {
+            requests.push_back(line);
+        }
+    }
+    cout << RunQueryLoad(socket_path, requests, connections, repeat) << endl;
+}
+#endif
+
+int main(int argc, char* argv[]) {
+    if (argc == 3 && argv[1] == "--jsonl"sv) {
+        ifstream base_input(argv[2]);
+        ServeJsonLines(base_input, cin, cout);
+        return 0;
+    }
+    if (argc == 4 && argv[1] == "--update"sv) {
+        UpdateCatalogue(argv[2], argv[3], cin, cout);
+        return 0;
+    }
+    if (argc == 4 && argv[1] == "--prepare-routes"sv) {
+        PrepareRoutes(argv[2], argv[3]);
+        return 0;
+    }
+    if ((argc == 4 || argc == 5) && argv[1] == "--matrix"sv) {
+        ifstream request_input(argv[3]);
+        BuildTravelMatrix(argv[2], request_input, cout, argc == 5 && argv[4] == "--binary"sv);
+        return 0;
+    }
+#ifdef __linux__
+    if ((argc == 4 || argc == 5) && argv[1] == "--serve"sv) {
+        ServeSocket(argv[2], argv[3], argc == 5 ? optional<string>(argv[4]) : nullopt);
+        return 0;
+    }
+    if (argc >= 4 && argv[1] == "--load"sv) {
+        ifstream requests_input(argv[3]);
+        size_t connections = argc > 4 ? stoul(argv[4]) : 1;
+        size_t repeat = argc > 5 ? stoul(argv[5]) : 1;
+        RunLoad(argv[2], requests_input, connections, repeat);
+        return 0;
+    }
+#endif
+
     // ifstream in("H:\\Programming\\Training_projects\\Transport_Catalogue_tests_data\\render_testCase_1_input.json");
     // ofstream file("H:\\Programming\\Training_projects\\Transport_Catalogue\\render_testCase_1_output_user.xml");
     // ReadAndRenderMap(in, file);
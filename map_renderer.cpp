@@ -1,65 +1,105 @@
 #include "map_renderer.h"
 #include <vector>
 #include <array>
+#include <algorithm>
 
 using namespace std;
 
 namespace map_renderer {
 
-class CoordinatesIt {
-public:
-    using value_type = const Geo::Coordinates;
-    using reference = const Geo::Coordinates&;
-    using pointer = const Geo::Coordinates*;
-    using difference_type = std::ptrdiff_t;
-    using iterator_category = std::forward_iterator_tag;
-
-    CoordinatesIt() = default;
-    explicit CoordinatesIt(std::set<const Stop*>::const_iterator it) : it_(it) {}
-
-    reference operator*() const { return (*it_)->coords_; }
-    pointer operator->() const { return &(*it_)->coords_; }
-
-    CoordinatesIt operator ++(int) {auto prev = *this; it_++; return prev;}
-    CoordinatesIt& operator ++() {it_++; return *this;}
-
-    bool operator ==(const CoordinatesIt& other) const {return it_ == other.it_; }
-    bool operator !=(const CoordinatesIt& other) const {return !(*this == other); }
-
-private:
-    std::set<const Stop*>::const_iterator it_;
-};
-
-    
 void MapRenderer::Draw(svg::ObjectContainer &container) const {
-    Geo::SphereProjector projector(CoordinatesIt(props_.stops_ptrs_.begin()), CoordinatesIt(props_.stops_ptrs_.end()),
-    props_.map_size_.width_, props_.map_size_.height_, props_.padding_);
+    MapLayout stale_layout;
+    const MapLayout& layout = GetLayout(stale_layout);
+    Geo::SphereProjector projector(layout.stops_coords_, props_.map_size_.width_, props_.map_size_.height_, props_.padding_);
+    vector<svg::Point> stops_points;
+    projector.RescaleCoordinates(layout.stops_coords_, stops_points);
+
+    container.SetColorTable(props_.colors_);
+    DrawRoutesLines(container, layout, stops_points);
+    DrawRoutesNames(container, layout, stops_points);
+    for (const svg::Point& point : stops_points) {
+        DrawStopCircles(container, point);
+    }
+    for (size_t i = 0; i < layout.stops_.size(); ++i) {
+        DrawStopName(container, *layout.stops_[i], stops_points[i]);
+    }
+}
 
-    DrawRoutesLines(container, projector);
-    DrawRoutesNames(container, projector);
-    for (auto& stop_ptr : props_.stops_ptrs_) {
-        DrawStopCircles(container, *stop_ptr, projector);   
+void MapRenderer::DrawSubnetwork(svg::ObjectContainer& container, const unordered_set<const Stop*>& stops) const {
+    MapLayout stale_layout;
+    const MapLayout& layout = GetLayout(stale_layout);
+    vector<uint32_t> drawn_stops;
+    Geo::CoordinatesArray drawn_coords(layout.stops_coords_.GetEncoding());
+    for (uint32_t i = 0; i < layout.stops_.size(); ++i) {
+        if (stops.contains(layout.stops_[i])) {
+            drawn_stops.push_back(i);
+            drawn_coords.PushBack(layout.stops_coords_.Get(i));
+        }
     }
-    for (auto& stop_ptr : props_.stops_ptrs_) {
-        DrawStopName(container, *stop_ptr, projector);
+    Geo::SphereProjector projector(drawn_coords, props_.map_size_.width_, props_.map_size_.height_, props_.padding_);
+    vector<svg::Point> drawn_points;
+    projector.RescaleCoordinates(drawn_coords, drawn_points);
+    vector<svg::Point> stops_points(layout.stops_.size());
+    for (size_t i = 0; i < drawn_stops.size(); ++i) {
+        stops_points[drawn_stops[i]] = drawn_points[i];
+    }
+
+    container.SetColorTable(props_.colors_);
+    DrawRoutesLines(container, layout, stops_points, &stops);
+    DrawRoutesNames(container, layout, stops_points, &stops);
+    for (const svg::Point& point : drawn_points) {
+        DrawStopCircles(container, point);
+    }
+    for (size_t i = 0; i < drawn_stops.size(); ++i) {
+        DrawStopName(container, *layout.stops_[drawn_stops[i]], drawn_points[i]);
     }
 }
 
 MapRenderer::MapRenderer() = default;
 
+MapRenderer::MapRenderer(const MapRenderer& other)
+    : props_(other.props_) {
+    props_.colors_ = make_shared<svg::ColorTable>(*other.props_.colors_);
+}
+
+MapRenderer& MapRenderer::operator=(const MapRenderer& other) {
+    if (this != &other) {
+        props_ = other.props_;
+        props_.colors_ = make_shared<svg::ColorTable>(*other.props_.colors_);
+    }
+    return *this;
+}
+
 const Route& MapRenderer::AddRoute(const Bus *bus_ptr) {
     Route new_route;
     new_route.bus_ptr_ = bus_ptr;
-    for (auto& stop : bus_ptr->route_) {
-        props_.stops_ptrs_.insert(stop);
-    }
     auto result = props_.routes_.insert({&(bus_ptr->name_), move(new_route)});
     if (!result.second) {
         throw runtime_error("The adding new route was unsucsessful"s);
     }
+    for (auto& stop : bus_ptr->route_) {
+        if (props_.stops_uses_[stop]++ == 0) {
+            props_.stops_ptrs_.insert(stop);
+        }
+    }
+    props_.is_layout_stale_ = true;
     return result.first->second;
 }
 
+void MapRenderer::RemoveRoute(const Bus* bus_ptr) {
+    if (props_.routes_.erase(&(bus_ptr->name_)) == 0) {
+        throw runtime_error("The removing route is not found: "s + bus_ptr->name_);
+    }
+    for (auto& stop : bus_ptr->route_) {
+        auto it = props_.stops_uses_.find(stop);
+        if (--it->second == 0) {
+            props_.stops_uses_.erase(it);
+            props_.stops_ptrs_.erase(stop);
+        }
+    }
+    props_.is_layout_stale_ = true;
+}
+
 void MapRenderer::ReorderRouteColors() {
     size_t i = 0;
     for (auto& [name_ptr, route] : props_.routes_) {
@@ -68,6 +108,58 @@ void MapRenderer::ReorderRouteColors() {
     }
 }
 
+void MapRenderer::UpdateLayout() {
+    props_.layout_ = MakeLayout();
+    props_.is_layout_stale_ = false;
+}
+
+void MapRenderer::MoveStop(const Stop* stop) {
+    if (props_.is_layout_stale_) {
+        return;
+    }
+    const vector<const Stop*>& stops = props_.layout_.stops_;
+    auto it = lower_bound(stops.begin(), stops.end(), stop, PtrsComparator<Stop>{});
+    if (it != stops.end() && *it == stop) {
+        props_.layout_.stops_coords_.Set(it - stops.begin(), stop->GetCoordinates());
+    }
+}
+
+MapLayout MapRenderer::MakeLayout() const {
+    MapLayout layout;
+    if (props_.stops_ptrs_.empty()) {
+        layout.routes_stops_.resize(props_.routes_.size());
+        return layout;
+    }
+    const Geo::CoordinatesArray& catalogue_coords = *(*props_.stops_ptrs_.begin())->coords_array_;
+    layout.stops_coords_ = Geo::CoordinatesArray(catalogue_coords.GetEncoding());
+    layout.stops_.reserve(props_.stops_ptrs_.size());
+    layout.stops_coords_.Reserve(props_.stops_ptrs_.size());
+    vector<uint32_t> positions(catalogue_coords.GetSize());
+    for (const Stop* stop : props_.stops_ptrs_) {
+        positions[stop->index_] = static_cast<uint32_t>(layout.stops_.size());
+        layout.stops_.push_back(stop);
+        layout.stops_coords_.PushBack(stop->GetCoordinates());
+    }
+
+    layout.routes_stops_.reserve(props_.routes_.size());
+    for (auto& [name_bus_ptr, route] : props_.routes_) {
+        vector<uint32_t>& route_stops = layout.routes_stops_.emplace_back();
+        route_stops.reserve(route.bus_ptr_->route_.size());
+        for (const Stop* stop : route.bus_ptr_->route_) {
+            route_stops.push_back(positions[stop->index_]);
+        }
+    }
+    return layout;
+}
+
+const MapLayout& MapRenderer::GetLayout(MapLayout& stale_layout) const {
+    if (!props_.is_layout_stale_) {
+        return props_.layout_;
+    }
+    stale_layout = MakeLayout();
+    return stale_layout;
+}
+
 MapRenderer &MapRenderer::SetMapSize(MapSize map_size) {
     props_.map_size_ = map_size;
     return *this;
@@ -111,7 +203,7 @@ MapRenderer& MapRenderer::SetBusLabelOffset(double x, double y) {
 }
 
 MapRenderer& MapRenderer::SetUnderLayerColor(const svg::Color& color) {
-    props_.underlayer_color_ = color;
+    props_.underlayer_color_ = props_.colors_->Intern(color);
     return *this;
 }
 
@@ -121,26 +213,57 @@ MapRenderer& MapRenderer::SetUnderLayerWidth(double width) {
 }
 
 void MapRenderer::AddColorToPalette(const svg::Color& color) {
-    props_.color_palette_.push_back(color);
+    props_.color_palette_.push_back(props_.colors_->Intern(color));
 }
 
-void MapRenderer::DrawRoutesLines(svg::ObjectContainer &container, const Geo::SphereProjector& projector) const {
+void MapRenderer::DrawRoutesLines(svg::ObjectContainer &container, const MapLayout& layout,
+    const vector<svg::Point>& points, const unordered_set<const Stop*>* stops) const {
+    size_t route_index = 0;
     for (auto& [name_bus_ptr, route] : props_.routes_) {
-        svg::Polyline line;
-        line.SetStrokeLineCap(svg::StrokeLineCap::ROUND).SetStrokeLineJoin(svg::StrokeLineJoin::ROUND).SetFillColor(svg::NoneColor).
-        SetStrokeWidth(props_.line_width_).SetStrokeColor(route.color_);
-
-        for (auto& stop : route.bus_ptr_->route_) {
-            svg::Point new_coords = projector.RescaleCoordinates(stop->coords_);
-            line.AddPoint(new_coords);
+        const vector<uint32_t>& route_stops = layout.routes_stops_[route_index++];
+        auto make_line = [&] {
+            svg::Polyline line;
+            line.SetStrokeLineCap(svg::StrokeLineCap::ROUND).SetStrokeLineJoin(svg::StrokeLineJoin::ROUND).SetFillColor(props_.none_color_).
+            SetStrokeWidth(props_.line_width_).SetStrokeColor(route.color_);
+            return line;
+        };
+
+        if (stops == nullptr) {
+            svg::Polyline line = make_line();
+            for (uint32_t stop : route_stops) {
+                line.AddPoint(points[stop]);
+            }
+            container.AddObject(line);
+            continue;
         }
 
-        container.AddObject(line);
+        size_t begin = 0;
+        while (begin < route_stops.size()) {
+            if (!stops->contains(layout.stops_[route_stops[begin]])) {
+                ++begin;
+                continue;
+            }
+            size_t end = begin + 1;
+            while (end < route_stops.size() && stops->contains(layout.stops_[route_stops[end]])) {
+                ++end;
+            }
+            if (end - begin > 1) {
+                svg::Polyline line = make_line();
+                for (size_t i = begin; i < end; ++i) {
+                    line.AddPoint(points[route_stops[i]]);
+                }
+                container.AddObject(line);
+            }
+            begin = end;
+        }
     }
 }
 
-void MapRenderer::DrawRoutesNames(svg::ObjectContainer& container, const Geo::SphereProjector& projector) const {
+void MapRenderer::DrawRoutesNames(svg::ObjectContainer& container, const MapLayout& layout,
+    const vector<svg::Point>& points, const unordered_set<const Stop*>* stops) const {
+    size_t route_index = 0;
     for (auto& [name_bus_ptr, route] : props_.routes_) {
+        const vector<uint32_t>& route_stops = layout.routes_stops_[route_index++];
         if (route.bus_ptr_->route_.empty()) {
             continue;
         }
@@ -153,14 +276,12 @@ void MapRenderer::DrawRoutesNames(svg::ObjectContainer& container, const Geo::Sp
         }
 
         for (int i = 0; i < texts.size(); i += 2) {
+            const Stop* label_stop = i == 0 ? bus.route_.front() : bus.route_[mid_id];
+            if (stops != nullptr && !stops->contains(label_stop)) {
+                continue;
+            }
             for (int d = i; d < (2 + i); d++) {
-                if (i == 0) {
-                    texts[d].SetPosition(projector.RescaleCoordinates(route.bus_ptr_->route_.front()->coords_));
-                }
-                else {
-                    auto& pre_end_bus = route.bus_ptr_->route_[route.bus_ptr_->route_.size() / 2];
-                    texts[d].SetPosition(projector.RescaleCoordinates(pre_end_bus->coords_));
-                }
+                texts[d].SetPosition(points[i == 0 ? route_stops.front() : route_stops[mid_id]]);
 
                 texts[d].SetOffset(props_.bus_label_offset_).SetFontSize(props_.bus_label_font_size_).SetFontFamily(props_.font_family_).
                 SetFontWeight(props_.font_route_weight_).SetData(route.bus_ptr_->name_);
@@ -176,18 +297,18 @@ void MapRenderer::DrawRoutesNames(svg::ObjectContainer& container, const Geo::Sp
     }
 }
 
-void MapRenderer::DrawStopCircles(svg::ObjectContainer& container, const Stop& stop, const Geo::SphereProjector& projector) const {
+void MapRenderer::DrawStopCircles(svg::ObjectContainer& container, svg::Point position) const {
     svg::Circle circle;
-    circle.SetCenter(projector.RescaleCoordinates(stop.coords_)).SetRadius(props_.stop_radius_).SetFillColor(props_.stop_circle_color_);
+    circle.SetCenter(position).SetRadius(props_.stop_radius_).SetFillColor(props_.stop_circle_color_);
     container.AddObject(circle);
 }
 
-void MapRenderer::DrawStopName(svg::ObjectContainer &container, const Stop& stop, const Geo::SphereProjector& projector) const {
+void MapRenderer::DrawStopName(svg::ObjectContainer &container, const Stop& stop, svg::Point position) const {
     array<svg::Text, 2> texts;
 
     for (int i = 0; i < 2; i++) {
         texts[i].SetData(string(stop.name_)).SetFontSize(props_.stop_label_font_size_).SetOffset(props_.stop_label_offset_).
-        SetPosition(projector.RescaleCoordinates(stop.coords_)).SetFontFamily(props_.font_family_);
+        SetPosition(position).SetFontFamily(props_.font_family_);
     }
 
     texts[0].SetFillColor(props_.stop_text_fill_);
@@ -3,6 +3,7 @@
 #include "svg.h" 
 #include "domain.h"
 #include <map>
+#include <unordered_set>
 
 using namespace std::literals;
 
@@ -16,7 +17,7 @@ struct MapSize {
 
 struct Route {
     const Bus* bus_ptr_;
-    svg::Color color_;
+    svg::ColorId color_{};
 
     bool operator <(const Route& other) const;
     bool operator <=(const Route& other) const;
@@ -24,9 +25,19 @@ struct Route {
     bool operator >=(const Route& other) const;
 };
 
+struct MapLayout {
+    std::vector<const Stop*> stops_;
+    Geo::CoordinatesArray stops_coords_;
+    std::vector<std::vector<uint32_t>> routes_stops_;
+};
+
 struct MapRendererProps {
+    std::shared_ptr<svg::ColorTable> colors_ = std::make_shared<svg::ColorTable>();
     std::map<const std::string*, Route, PtrsComparator<std::string>> routes_;
     std::set<const Stop*, PtrsComparator<Stop>> stops_ptrs_;
+    std::unordered_map<const Stop*, size_t> stops_uses_;
+    MapLayout layout_;
+    bool is_layout_stale_ = true;
     MapSize map_size_;
     double padding_ = 0.0;
     double line_width_ = 0.0;
@@ -37,17 +48,23 @@ struct MapRendererProps {
     svg::Point stop_label_offset_;
     std::string font_family_ = "Verdana"s;
     std::string font_route_weight_ = "bold"s;
-    svg::Color underlayer_color_;
+    svg::ColorId underlayer_color_ = colors_->Intern(std::monostate{});
     double underlayer_width_ = 0.0;
-    std::vector<svg::Color> color_palette_;
-    svg::Color stop_circle_color_ = "white"s;
-    svg::Color stop_text_fill_ = "black"s;
+    std::vector<svg::ColorId> color_palette_;
+    svg::ColorId none_color_ = colors_->Intern(svg::NoneColor);
+    svg::ColorId stop_circle_color_ = colors_->Intern("white"s);
+    svg::ColorId stop_text_fill_ = colors_->Intern("black"s);
 };
 
 class MapRenderer : public svg::Drawable {
 public:
     MapRenderer();
+    MapRenderer(const MapRenderer& other);
+    MapRenderer(MapRenderer&& other) = default;
+    MapRenderer& operator=(const MapRenderer& other);
+    MapRenderer& operator=(MapRenderer&& other) = default;
     void Draw(svg::ObjectContainer& container) const override;
+    void DrawSubnetwork(svg::ObjectContainer& container, const std::unordered_set<const Stop*>& stops) const;
     MapRenderer& SetMapSize(MapSize map_size);
     MapRenderer& SetPadding(double padding);
     MapRenderer& SetLineWidth(double width);
@@ -60,13 +77,20 @@ public:
     MapRenderer& SetUnderLayerWidth(double width);
     void AddColorToPalette(const svg::Color& color);
     const Route& AddRoute(const Bus* bus_ptr);
+    void RemoveRoute(const Bus* bus_ptr);
     void ReorderRouteColors();
+    void UpdateLayout();
+    void MoveStop(const Stop* stop);
 
 private:
-    void DrawRoutesLines(svg::ObjectContainer& container, const Geo::SphereProjector& projector) const;
-    void DrawRoutesNames(svg::ObjectContainer& container, const Geo::SphereProjector& projector) const;
-    void DrawStopCircles(svg::ObjectContainer& container, const Stop& stop, const Geo::SphereProjector& projector) const;
-    void DrawStopName(svg::ObjectContainer& container, const Stop& stop, const Geo::SphereProjector& projector) const;
+    MapLayout MakeLayout() const;
+    const MapLayout& GetLayout(MapLayout& stale_layout) const;
+    void DrawRoutesLines(svg::ObjectContainer& container, const MapLayout& layout, const std::vector<svg::Point>& points,
+        const std::unordered_set<const Stop*>* stops = nullptr) const;
+    void DrawRoutesNames(svg::ObjectContainer& container, const MapLayout& layout, const std::vector<svg::Point>& points,
+        const std::unordered_set<const Stop*>* stops = nullptr) const;
+    void DrawStopCircles(svg::ObjectContainer& container, svg::Point position) const;
+    void DrawStopName(svg::ObjectContainer& container, const Stop& stop, svg::Point position) const;
 
     MapRendererProps props_;
 };
@@ -0,0 +1,143 @@
+#include "query_client.h"
+#ifdef __linux__
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <ostream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace std;
+
+QueryClient::QueryClient(const string& socket_path) {
+    sockaddr_un address{};
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        throw invalid_argument("Socket path is too long: "s + socket_path);
+    }
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+    fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) {
+        throw runtime_error("socket failed: "s + strerror(errno));
+    }
+    if (connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        close(fd_);
+        throw runtime_error("connect failed: "s + strerror(errno));
+    }
+}
+
+QueryClient::~QueryClient() {
+    close(fd_);
+}
+
+void QueryClient::Send(const string& request_line) {
+    string message = request_line + '\n';
+    size_t sent = 0;
+    while (sent < message.size()) {
+        ssize_t size = send(fd_, message.data() + sent, message.size() - sent, MSG_NOSIGNAL);
+        if (size < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw runtime_error("send failed: "s + strerror(errno));
+        }
+        sent += size;
+    }
+}
+
+string QueryClient::Receive() {
+    char chunk[4096];
+    size_t line_end = buffer_.find('\n');
+    while (line_end == string::npos) {
+        ssize_t size = read(fd_, chunk, sizeof(chunk));
+        if (size < 0 && errno == EINTR) {
+            continue;
+        }
+        if (size <= 0) {
+            throw runtime_error("Connection is closed before the answer"s);
+        }
+        buffer_.append(chunk, size);
+        line_end = buffer_.find('\n');
+    }
+    string line = buffer_.substr(0, line_end);
+    buffer_.erase(0, line_end + 1);
+    return line;
+}
+
+string QueryClient::Ask(const string& request_line) {
+    Send(request_line);
+    return Receive();
+}
+
+QueryLoadReport RunQueryLoad(const string& socket_path, const vector<string>& requests, 
+    size_t connections, size_t repeat) {
+    connections = max<size_t>(connections, 1);
+    vector<vector<double>> latencies(connections);
+    vector<size_t> errors(connections, 0);
+    vector<exception_ptr> failures(connections);
+
+    const auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    workers.reserve(connections);
+    for (size_t worker = 0; worker < connections; ++worker) {
+        workers.emplace_back([&, worker] {
+            try {
+                QueryClient client(socket_path);
+                for (size_t round = 0; round < repeat; ++round) {
+                    for (size_t i = worker; i < requests.size(); i += connections) {
+                        const auto sent = chrono::steady_clock::now();
+                        string answer = client.Ask(requests[i]);
+                        const auto received = chrono::steady_clock::now();
+                        latencies[worker].push_back(chrono::duration<double, milli>(received - sent).count());
+                        if (answer.find("\"error_message\""s) != string::npos) {
+                            ++errors[worker];
+                        }
+                    }
+                }
+            } catch (...) {
+                failures[worker] = current_exception();
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (auto& failure : failures) {
+        if (failure) {
+            rethrow_exception(failure);
+        }
+    }
+
+    QueryLoadReport report;
+    report.seconds_ = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    vector<double> all;
+    for (size_t worker = 0; worker < connections; ++worker) {
+        all.insert(all.end(), latencies[worker].begin(), latencies[worker].end());
+        report.error_answers_ += errors[worker];
+    }
+    report.requests_ = all.size();
+    if (!all.empty()) {
+        sort(all.begin(), all.end());
+        report.p50_ms_ = all[all.size() / 2];
+        report.p99_ms_ = all[min(all.size() - 1, all.size() * 99 / 100)];
+        report.max_ms_ = all.back();
+    }
+    return report;
+}
+
+ostream& operator <<(ostream& out, const QueryLoadReport& report) {
+    out << "requests: " << report.requests_ << ", error answers: " << report.error_answers_ 
+        << ", seconds: " << report.seconds_ 
+        << ", rps: " << (report.seconds_ > 0 ? report.requests_ / report.seconds_ : 0.0)
+        << ", p50 ms: " << report.p50_ms_ << ", p99 ms: " << report.p99_ms_ << ", max ms: " << report.max_ms_;
+    return out;
+}
+
+#endif
@@ -0,0 +1,39 @@
+#pragma once
+#ifdef __linux__
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+class QueryClient {
+public:
+    explicit QueryClient(const std::string& socket_path);
+    QueryClient(const QueryClient&) = delete;
+    QueryClient& operator=(const QueryClient&) = delete;
+    ~QueryClient();
+
+    void Send(const std::string& request_line);
+    std::string Receive();
+    std::string Ask(const std::string& request_line);
+
+private:
+    int fd_ = -1;
+    std::string buffer_;
+};
+
+struct QueryLoadReport {
+    size_t requests_ = 0;
+    size_t error_answers_ = 0;
+    double seconds_ = 0.0;
+    double p50_ms_ = 0.0;
+    double p99_ms_ = 0.0;
+    double max_ms_ = 0.0;
+};
+
+QueryLoadReport RunQueryLoad(const std::string& socket_path, const std::vector<std::string>& requests, 
+    size_t connections, size_t repeat = 1);
+
+std::ostream& operator <<(std::ostream& out, const QueryLoadReport& report);
+
+#endif
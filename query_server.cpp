@@ -0,0 +1,314 @@
+#include "query_server.h"
+#ifdef __linux__
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+
+using namespace std;
+
+namespace {
+
+const uint64_t LISTEN_ID = 0;
+const uint64_t WAKE_ID = 1;
+const int MAX_EVENTS = 64;
+const size_t READ_CHUNK = 4096;
+const uint64_t MAX_IN_FLIGHT = 256;
+const size_t MAX_PENDING_OUTPUT = 1 << 20;
+const size_t MAX_PENDING_INPUT = 1 << 20;
+
+void ThrowSystemError(const string& what) {
+    throw runtime_error(what + ": "s + strerror(errno));
+}
+
+void SetEvents(int epoll_fd, int fd, uint64_t id, uint32_t events, int operation) {
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = id;
+    if (epoll_ctl(epoll_fd, operation, fd, &event) < 0) {
+        ThrowSystemError("epoll_ctl failed"s);
+    }
+}
+
+}
+
+QueryServer::QueryServer(const SnapshotHolder& snapshots, StatScheduler& scheduler)
+    : snapshots_(snapshots), scheduler_(scheduler) {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        ThrowSystemError("epoll_create1 failed"s);
+    }
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        ThrowSystemError("eventfd failed"s);
+    }
+    SetEvents(epoll_fd_, wake_fd_, WAKE_ID, EPOLLIN, EPOLL_CTL_ADD);
+}
+
+QueryServer::~QueryServer() {
+    scheduler_.Wait();
+    for (auto& [id, connection] : connections_) {
+        close(connection.fd_);
+    }
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        unlink(socket_path_.c_str());
+    }
+    close(wake_fd_);
+    close(epoll_fd_);
+}
+
+void QueryServer::Listen(const string& socket_path) {
+    sockaddr_un address{};
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        throw invalid_argument("Socket path is too long: "s + socket_path);
+    }
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        ThrowSystemError("socket failed"s);
+    }
+    unlink(socket_path.c_str());
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        ThrowSystemError("bind failed"s);
+    }
+    socket_path_ = socket_path;
+    if (listen(listen_fd_, SOMAXCONN) < 0) {
+        ThrowSystemError("listen failed"s);
+    }
+    SetEvents(epoll_fd_, listen_fd_, LISTEN_ID, EPOLLIN, EPOLL_CTL_ADD);
+}
+
+void QueryServer::Run() {
+    epoll_event events[MAX_EVENTS];
+
+    while (true) {
+        int count = epoll_wait(epoll_fd_, events, MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowSystemError("epoll_wait failed"s);
+        }
+
+        for (int i = 0; i < count; ++i) {
+            const uint64_t id = events[i].data.u64;
+            if (id == LISTEN_ID) {
+                Accept();
+                continue;
+            }
+            if (id == WAKE_ID) {
+                uint64_t counter = 0;
+                [[maybe_unused]] auto read_size = read(wake_fd_, &counter, sizeof(counter));
+                DrainCompletions();
+                continue;
+            }
+
+            auto it = connections_.find(id);
+            if (it == connections_.end()) {
+                continue;
+            }
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                Close(id);
+                continue;
+            }
+            if (events[i].events & EPOLLIN) {
+                ReadFrom(id, it->second);
+            }
+            it = connections_.find(id);
+            if (it != connections_.end() && (events[i].events & EPOLLOUT)) {
+                WriteTo(id, it->second);
+            }
+        }
+
+        lock_guard lock(completions_mutex_);
+        if (stopped_) {
+            return;
+        }
+    }
+}
+
+void QueryServer::Stop() {
+    {
+        lock_guard lock(completions_mutex_);
+        stopped_ = true;
+    }
+    Wake();
+}
+
+void QueryServer::Accept() {
+    while (true) {
+        int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                return;
+            }
+            ThrowSystemError("accept failed"s);
+        }
+        const uint64_t id = next_connection_id_++;
+        connections_[id].fd_ = fd;
+        SetEvents(epoll_fd_, fd, id, EPOLLIN | EPOLLRDHUP, EPOLL_CTL_ADD);
+    }
+}
+
+void QueryServer::ReadFrom(uint64_t connection_id, Connection& connection) {
+    char buffer[READ_CHUNK];
+    while (!IsSaturated(connection)) {
+        ssize_t size = read(connection.fd_, buffer, sizeof(buffer));
+        if (size > 0) {
+            connection.input_.append(buffer, size);
+            Dispatch(connection_id, connection);
+            if (connection.input_.size() > MAX_PENDING_INPUT) {
+                Close(connection_id);
+                return;
+            }
+            continue;
+        }
+        if (size == 0) {
+            connection.closing_ = true;
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        }
+        Close(connection_id);
+        return;
+    }
+    UpdateEvents(connection_id, connection);
+}
+
+void QueryServer::Dispatch(uint64_t connection_id, Connection& connection) {
+    size_t line_begin = 0;
+    for (size_t line_end = connection.input_.find('\n'); line_end != string::npos && !IsSaturated(connection); 
+        line_end = connection.input_.find('\n', line_begin)) {
+        string line = connection.input_.substr(line_begin, line_end - line_begin);
+        line_begin = line_end + 1;
+        if (line.find_first_not_of(" \t\r"s) == string::npos) {
+            continue;
+        }
+
+        const uint64_t seq = connection.next_seq_++;
+        scheduler_.GetLightPool().Submit([this, connection_id, seq, line = move(line)] {
+            JsonReader reader;
+            shared_ptr<const StatJsonLine> request = reader.ReadStatJsonLine(line);
+            if (request->stat_ && scheduler_.IsHeavy(request->stat_->type_)) {
+                scheduler_.GetHeavyPool().Submit([this, connection_id, seq, request] {
+                    Complete(connection_id, seq, *request);
+                });
+                return;
+            }
+            Complete(connection_id, seq, *request);
+        });
+    }
+    connection.input_.erase(0, line_begin);
+}
+
+bool QueryServer::IsSaturated(const Connection& connection) const {
+    return connection.next_seq_ - connection.flushed_seq_ >= MAX_IN_FLIGHT 
+        || connection.output_.size() >= MAX_PENDING_OUTPUT;
+}
+
+void QueryServer::WriteTo(uint64_t connection_id, Connection& connection) {
+    while (!connection.output_.empty()) {
+        ssize_t size = send(connection.fd_, connection.output_.data(), connection.output_.size(), MSG_NOSIGNAL);
+        if (size < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            Close(connection_id);
+            return;
+        }
+        connection.output_.erase(0, size);
+    }
+    Dispatch(connection_id, connection);
+    UpdateEvents(connection_id, connection);
+}
+
+void QueryServer::UpdateEvents(uint64_t connection_id, Connection& connection) {
+    if (connection.closing_ && connection.next_seq_ == connection.flushed_seq_ && connection.output_.empty()) {
+        Close(connection_id);
+        return;
+    }
+
+    uint32_t events = connection.closing_ || IsSaturated(connection) ? 0 : EPOLLIN | EPOLLRDHUP;
+    if (!connection.output_.empty()) {
+        events |= EPOLLOUT;
+    }
+    SetEvents(epoll_fd_, connection.fd_, connection_id, events, EPOLL_CTL_MOD);
+}
+
+void QueryServer::DrainCompletions() {
+    vector<Completion> completions;
+    {
+        lock_guard lock(completions_mutex_);
+        completions.swap(completions_);
+    }
+
+    vector<uint64_t> touched;
+    for (auto& completion : completions) {
+        auto it = connections_.find(completion.connection_id_);
+        if (it == connections_.end()) {
+            continue;
+        }
+        touched.push_back(it->first);
+        Connection& connection = it->second;
+        connection.ready_[completion.seq_] = move(completion.answer_);
+
+        for (auto ready_it = connection.ready_.begin(); 
+            ready_it != connection.ready_.end() && ready_it->first == connection.flushed_seq_; 
+            ready_it = connection.ready_.erase(ready_it)) {
+            connection.output_ += ready_it->second;
+            connection.output_ += '\n';
+            ++connection.flushed_seq_;
+        }
+    }
+
+    sort(touched.begin(), touched.end());
+    touched.erase(unique(touched.begin(), touched.end()), touched.end());
+    for (uint64_t connection_id : touched) {
+        WriteTo(connection_id, connections_.at(connection_id));
+    }
+}
+
+void QueryServer::Close(uint64_t connection_id) {
+    auto it = connections_.find(connection_id);
+    if (it == connections_.end()) {
+        return;
+    }
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, it->second.fd_, nullptr);
+    close(it->second.fd_);
+    connections_.erase(it);
+}
+
+void QueryServer::Complete(uint64_t connection_id, uint64_t seq, const StatJsonLine& request) {
+    JsonReader reader;
+    shared_ptr<const CatalogueSnapshot> snapshot = snapshots_.Load();
+    string answer = reader.AnswerStatJson(request, snapshot->handler_, snapshot->transport_c_, snapshot->route_map_);
+    {
+        lock_guard lock(completions_mutex_);
+        completions_.push_back({connection_id, seq, move(answer)});
+    }
+    Wake();
+}
+
+void QueryServer::Wake() {
+    const uint64_t counter = 1;
+    [[maybe_unused]] auto write_size = write(wake_fd_, &counter, sizeof(counter));
+}
+
+#endif
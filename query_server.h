@@ -0,0 +1,70 @@
+#pragma once
+#ifdef __linux__
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "catalogue_snapshot.h"
+#include "request_handler.h"
+#include "json_reader.h"
+
+class QueryServer {
+public:
+    QueryServer(const SnapshotHolder& snapshots, StatScheduler& scheduler);
+    QueryServer(const QueryServer&) = delete;
+    QueryServer& operator=(const QueryServer&) = delete;
+    ~QueryServer();
+
+    void Listen(const std::string& socket_path);
+    void Run();
+    void Stop();
+
+private:
+    struct Connection {
+        int fd_ = -1;
+        std::string input_;
+        std::string output_;
+        uint64_t next_seq_ = 0;
+        uint64_t flushed_seq_ = 0;
+        std::map<uint64_t, std::string> ready_;
+        bool closing_ = false;
+    };
+
+    struct Completion {
+        uint64_t connection_id_ = 0;
+        uint64_t seq_ = 0;
+        std::string answer_;
+    };
+
+    void Accept();
+    void ReadFrom(uint64_t connection_id, Connection& connection);
+    void Dispatch(uint64_t connection_id, Connection& connection);
+    bool IsSaturated(const Connection& connection) const;
+    void WriteTo(uint64_t connection_id, Connection& connection);
+    void UpdateEvents(uint64_t connection_id, Connection& connection);
+    void DrainCompletions();
+    void Close(uint64_t connection_id);
+    void Complete(uint64_t connection_id, uint64_t seq, const StatJsonLine& request);
+    void Wake();
+
+    const SnapshotHolder& snapshots_;
+    StatScheduler& scheduler_;
+
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    bool stopped_ = false;
+    std::string socket_path_;
+    uint64_t next_connection_id_ = 2;
+    std::unordered_map<uint64_t, Connection> connections_;
+
+    std::mutex completions_mutex_;
+    std::vector<Completion> completions_;
+};
+
+#endif
@@ -1,17 +1,39 @@
 #include "request_handler.h"
+#include <future>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace std;
 
+namespace {
+
+using StatKey = tuple<RequestType, string_view, string_view, string_view, double, bool, double, double, double, size_t, double>;
+
+struct StatKeyHasher {
+    size_t operator()(const StatKey& key) const {
+        size_t result = 0;
+        apply([&result](const auto&... values) {
+            ((result = result * 37 + hash<decay_t<decltype(values)>>{}(values)), ...);
+        }, key);
+        return result;
+    }
+};
+
+}
+
 Request::Request(RequestType type) : type_(type) {}
 
 Stat::Stat(RequestType type, int id) : Request(type), id_(id) {}
 
-StatStop::StatStop(RequestType type, int id) : Stat(type, id) {}
+StatBus::StatBus(const RouteStatistics& parent, int id) 
+: RouteStatistics(parent), id_(id) {}
 
-StatBus::StatBus(const RouteStatistics& parent, RequestType type, int id) 
-: RouteStatistics(parent), Stat(type, id) {}
+StatRoute::StatRoute(RouteInfo&& parent, int id)
+: RouteInfo(move(parent)), id_(id) {}
 
-StatMap::StatMap(RequestType type, int id) : Stat(type, id) {}
+StatJourney::StatJourney(JourneyInfo&& parent, int id)
+: JourneyInfo(move(parent)), id_(id) {}
 
 RequestBaseStop::RequestBaseStop(RequestType type, Geo::Coordinates coords)
 : Request(type), coords_(coords) {}
@@ -19,6 +41,27 @@ RequestBaseStop::RequestBaseStop(RequestType type, Geo::Coordinates coords)
 RequestBaseBus::RequestBaseBus(RequestType type, bool is_round_trip)
 : Request(type), is_round_trip_(is_round_trip) {}
 
+StatScheduler::StatScheduler(size_t light_threads, size_t heavy_threads)
+    : light_pool_(light_threads), heavy_pool_(heavy_threads) {}
+
+bool StatScheduler::IsHeavy(RequestType type) const {
+    return type == RequestType::Map || type == RequestType::Route
+        || type == RequestType::Journey || type == RequestType::Isochrone;
+}
+
+ThreadPool& StatScheduler::GetLightPool() {
+    return light_pool_;
+}
+
+ThreadPool& StatScheduler::GetHeavyPool() {
+    return heavy_pool_;
+}
+
+void StatScheduler::Wait() {
+    light_pool_.Wait();
+    heavy_pool_.Wait();
+}
+
 RequestHander::RequestHander() = default;
 
 void RequestHander::AddRequest(Request& base_request) {
@@ -45,14 +88,6 @@ void RequestBaseStop::MoveToHandler(RequestHander &handler) {
     handler.AddRequest(move(*this));
 }
 
-void StatBus::MoveToHandler(RequestHander &handler) {
-    handler.AddRequest(move(*this));
-}
-
-void StatStop::MoveToHandler(RequestHander &handler) {
-    handler.AddRequest(move(*this));
-}
-
 void Stat::MoveToHandler(RequestHander &handler) {
     handler.AddRequest(*this);
 }
@@ -79,66 +114,286 @@ void RequestHander::ProvideInputRequests(TransportCatalogue &transport_c) {
         }
         transport_c.AddBus(bus_request.name_, route, bus_request.is_round_trip_);
     }
+    transport_c.ReorderStopsAlongHilbertCurve();
 }
 
-vector<shared_ptr<Stat>> RequestHander::GetStats(const TransportCatalogue &transport_c, 
-    const std::optional<map_renderer::MapRenderer>& route_map) const {
-    vector<shared_ptr<Stat>> stats;
+void RequestHander::SetStatFragments(const StatFragments* fragments) {
+    fragments_ = fragments;
+}
 
-    for (auto& request : stat_requests_) {
-        switch (request.type_) {
-        case RequestType::Bus:
-            PushBusStat(transport_c, request, stats);
-            break;
-        
-        case RequestType::Stop:
-            PushStopStat(transport_c, request, stats);
-            break;
+void RequestHander::SetRouter(const TransportRouter* router) {
+    router_ = router;
+    if (route_cache_ != nullptr) {
+        route_cache_->Clear();
+    }
+}
+
+void RequestHander::SetTimetable(const Timetable* timetable) {
+    timetable_ = timetable;
+}
+
+void RequestHander::SetStopsIndex(const StopsIndex* stops_index) {
+    stops_index_ = stops_index;
+}
+
+void RequestHander::SetSegmentsIndex(const SegmentsIndex* segments_index) {
+    segments_index_ = segments_index;
+}
+
+void RequestHander::SetRouteCache(RouteCache* route_cache, uint64_t version) {
+    route_cache_ = route_cache;
+    route_cache_version_ = version;
+}
 
-        case RequestType::Map:
-            PushMapStat(route_map.value(), request, stats);
-            break;
+vector<StatAnswer> RequestHander::GetStats(const TransportCatalogue &transport_c, 
+    const std::optional<map_renderer::MapRenderer>& route_map) const {
+    vector<size_t> origins = FindRequestOrigins();
+    vector<StatAnswer> stats;
+    stats.reserve(stat_requests_.size());
 
-        default:
-            break;
+    for (size_t i = 0; i < stat_requests_.size(); ++i) {
+        if (origins[i] != i) {
+            stats.push_back(StatDuplicate{stat_requests_[i].id_, origins[i]});
+            continue;
         }
+        stats.push_back(GetStat(transport_c, stat_requests_[i], route_map));
     }
     
     return stats;
 }
 
-void RequestHander::PushBusStat(const TransportCatalogue &transport_c, 
+vector<StatAnswer> RequestHander::GetStatsParallel(const TransportCatalogue &transport_c, 
+    ThreadPool& pool,
+    const std::optional<map_renderer::MapRenderer>& route_map) const {
+    vector<size_t> origins = FindRequestOrigins();
+    vector<StatAnswer> stats(stat_requests_.size());
+    vector<size_t> distinct;
+
+    for (size_t i = 0; i < stat_requests_.size(); ++i) {
+        if (origins[i] != i) {
+            stats[i] = StatDuplicate{stat_requests_[i].id_, origins[i]};
+            continue;
+        }
+        distinct.push_back(i);
+    }
+
+    pool.ParallelFor(distinct.size(), [&](size_t i) {
+        stats[distinct[i]] = GetStat(transport_c, stat_requests_[distinct[i]], route_map);
+    });
+
+    return stats;
+}
+
+vector<StatAnswer> RequestHander::GetStatsParallel(const TransportCatalogue &transport_c, 
+    StatScheduler& scheduler,
+    const std::optional<map_renderer::MapRenderer>& route_map) const {
+    vector<size_t> origins = FindRequestOrigins();
+    vector<StatAnswer> stats(stat_requests_.size());
+    vector<size_t> light;
+    vector<size_t> heavy;
+
+    for (size_t i = 0; i < stat_requests_.size(); ++i) {
+        if (origins[i] != i) {
+            stats[i] = StatDuplicate{stat_requests_[i].id_, origins[i]};
+            continue;
+        }
+        (scheduler.IsHeavy(stat_requests_[i].type_) ? heavy : light).push_back(i);
+    }
+
+    auto answer = [&](const vector<size_t>& indexes) {
+        return [&](size_t i) {
+            stats[indexes[i]] = GetStat(transport_c, stat_requests_[indexes[i]], route_map);
+        };
+    };
+    promise<void> heavy_done;
+    future<void> heavy_future = heavy_done.get_future();
+    scheduler.GetHeavyPool().Submit([&] {
+        try {
+            scheduler.GetHeavyPool().ParallelFor(heavy.size(), answer(heavy));
+            heavy_done.set_value();
+        } catch (...) {
+            heavy_done.set_exception(current_exception());
+        }
+    });
+
+    exception_ptr light_error;
+    try {
+        scheduler.GetLightPool().ParallelFor(light.size(), answer(light));
+    } catch (...) {
+        light_error = current_exception();
+    }
+    heavy_future.wait();
+    if (light_error) {
+        rethrow_exception(light_error);
+    }
+    heavy_future.get();
+
+    return stats;
+}
+
+vector<size_t> RequestHander::FindRequestOrigins() const {
+    unordered_map<StatKey, size_t, StatKeyHasher> first_requests;
+    first_requests.reserve(stat_requests_.size());
+    vector<size_t> origins;
+    origins.reserve(stat_requests_.size());
+
+    for (size_t i = 0; i < stat_requests_.size(); ++i) {
+        const Stat& request = stat_requests_[i];
+        auto [it, inserted] = first_requests.try_emplace(StatKey{request.type_, request.name_, request.from_, request.to_, request.time_limit_, request.render_,
+            request.departure_time_, request.coords_.lat, request.coords_.lng, request.count_, request.radius_}, i);
+        origins.push_back(it->second);
+    }
+
+    return origins;
+}
+
+StatAnswer RequestHander::GetStat(const TransportCatalogue &transport_c, 
     const Stat& stat, 
-    std::vector<std::shared_ptr<Stat>> &container) const {
+    const std::optional<map_renderer::MapRenderer>& route_map) const {
+    switch (stat.type_) {
+    case RequestType::Bus:
+        return BuildBusStat(transport_c, stat);
+
+    case RequestType::Stop:
+        return BuildStopStat(transport_c, stat);
+
+    case RequestType::Map:
+        return BuildMapStat(route_map.value(), stat);
+
+    case RequestType::Route:
+        return BuildRouteStat(stat);
+
+    case RequestType::Isochrone:
+        return BuildIsochroneStat(stat, route_map);
+
+    case RequestType::Journey:
+        return BuildJourneyStat(stat);
+
+    case RequestType::NearestStops:
+    case RequestType::StopsInRadius:
+        return BuildNearbyStopsStat(stat);
+
+    case RequestType::BusesNearby:
+        return BuildNearbyBusesStat(stat);
+
+    default:
+        return StatError{stat.id_};
+    }
+}
+
+StatAnswer RequestHander::BuildBusStat(const TransportCatalogue &transport_c, 
+    const Stat& stat) const {
+
+    if (fragments_ != nullptr) {
+        if (const string* fragment = fragments_->FindBus(stat.name_)) {
+            return StatFragment{stat.id_, fragment};
+        }
+    }
 
     auto statistics_opt = transport_c.GetRouteStatistics(stat.name_);
     if (!statistics_opt) {
-        container.push_back(make_shared<Stat>(RequestType::Error, stat.id_));
-        return;
+        return StatError{stat.id_};
     }
-    container.push_back(make_shared<StatBus>(statistics_opt.value(), RequestType::Bus, stat.id_));
+    return StatBus(statistics_opt.value(), stat.id_);
 }
 
-void RequestHander::PushStopStat(const TransportCatalogue &transport_c, 
-    const Stat& stat,  
-    std::vector<std::shared_ptr<Stat>> &container) const {
+StatAnswer RequestHander::BuildStopStat(const TransportCatalogue &transport_c, 
+    const Stat& stat) const {
+
+    if (fragments_ != nullptr) {
+        if (const string* fragment = fragments_->FindStop(stat.name_)) {
+            return StatFragment{stat.id_, fragment};
+        }
+    }
         
-    StatStop stat_stop(RequestType::Stop, stat.id_);
     auto stop = transport_c.FindStop(stat.name_);
     if (stop == nullptr) {
-        container.push_back(make_shared<Stat>(RequestType::Error, stat.id_));
-        return;
+        return StatError{stat.id_};
     }
-    stat_stop.buses_ = transport_c.FindBuses(stat.name_);
-    container.push_back(make_shared<StatStop>(move(stat_stop)));
-    return;
+    return StatStop{stat.id_, transport_c.FindBuses(stat.name_)};
 }
 
-void RequestHander::PushMapStat(const map_renderer::MapRenderer& route_map, 
-    const Stat &stat, 
-    std::vector<std::shared_ptr<Stat>> &container) const {
+StatAnswer RequestHander::BuildMapStat(const map_renderer::MapRenderer& route_map, 
+    const Stat &stat) const {
 
-    StatMap drawn_map(RequestType::Map, stat.id_);
+    StatMap drawn_map{stat.id_, {}};
     route_map.Draw(drawn_map.map_);
-    container.push_back(make_shared<StatMap>(move(drawn_map)));
+    return drawn_map;
+}
+
+StatAnswer RequestHander::BuildRouteStat(const Stat &stat) const {
+    if (router_ == nullptr) {
+        throw logic_error("Routing settings are not provided"s);
+    }
+
+    if (route_cache_ != nullptr) {
+        if (optional<CachedRoute> cached = route_cache_->Find(stat.from_, stat.to_, route_cache_version_)) {
+            if (!*cached) {
+                return StatError{stat.id_};
+            }
+            return StatRoute(move(**cached), stat.id_);
+        }
+    }
+
+    auto route = router_->BuildRoute(stat.from_, stat.to_);
+    if (route_cache_ != nullptr) {
+        route_cache_->Insert(stat.from_, stat.to_, route_cache_version_, route);
+    }
+    if (!route) {
+        return StatError{stat.id_};
+    }
+    return StatRoute(move(*route), stat.id_);
+}
+
+StatAnswer RequestHander::BuildJourneyStat(const Stat& stat) const {
+    if (timetable_ == nullptr) {
+        throw logic_error("Schedules are not provided"s);
+    }
+
+    auto journey = timetable_->BuildJourney(stat.from_, stat.to_, stat.departure_time_);
+    if (!journey) {
+        return StatError{stat.id_};
+    }
+    return StatJourney(move(*journey), stat.id_);
+}
+
+StatAnswer RequestHander::BuildNearbyStopsStat(const Stat& stat) const {
+    if (stops_index_ == nullptr) {
+        throw logic_error("Stops index is not provided"s);
+    }
+
+    if (stat.type_ == RequestType::NearestStops) {
+        return StatNearbyStops{stat.id_, stops_index_->FindNearest(stat.coords_, stat.count_)};
+    }
+    return StatNearbyStops{stat.id_, stops_index_->FindWithinRadius(stat.coords_, stat.radius_)};
+}
+
+StatAnswer RequestHander::BuildNearbyBusesStat(const Stat& stat) const {
+    if (segments_index_ == nullptr) {
+        throw logic_error("Segments index is not provided"s);
+    }
+    return StatNearbyBuses{stat.id_, segments_index_->FindBusesWithinRadius(stat.coords_, stat.radius_)};
+}
+
+StatAnswer RequestHander::BuildIsochroneStat(const Stat& stat,
+    const std::optional<map_renderer::MapRenderer>& route_map) const {
+    if (router_ == nullptr) {
+        throw logic_error("Routing settings are not provided"s);
+    }
+
+    auto reachable = router_->BuildIsochrone(stat.from_, stat.time_limit_);
+    if (!reachable) {
+        return StatError{stat.id_};
+    }
+
+    StatIsochrone isochrone{stat.id_, move(*reachable), nullopt};
+    if (stat.render_) {
+        unordered_set<const Stop*> stops;
+        for (const ReachableStop& reachable_stop : isochrone.stops_) {
+            stops.insert(reachable_stop.stop_);
+        }
+        isochrone.map_.emplace();
+        route_map.value().DrawSubnetwork(*isochrone.map_, stops);
+    }
+    return isochrone;
 }
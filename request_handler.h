@@ -1,9 +1,16 @@
 #pragma once
 #include <memory>
+#include <variant>
 #include "transport_catalogue.h"
 #include "map_renderer.h"
+#include "thread_pool.h"
+#include "stat_fragments.h"
+#include "transport_router.h"
+#include "route_cache.h"
+#include "timetable.h"
+#include "spatial_index.h"
 
-enum class RequestType {Bus, Stop, Map, Error};
+enum class RequestType {Bus, Stop, Map, Route, Isochrone, Journey, NearestStops, StopsInRadius, BusesNearby, Error};
 
 class RequestHander;
 
@@ -41,25 +48,86 @@ struct Stat : public Request {
     Stat(RequestType type = RequestType::Bus, int id = 0);
     void MoveToHandler(RequestHander& handler) override;
     int id_ = 0;
+    std::string_view from_;
+    std::string_view to_;
+    double time_limit_ = 0.0;
+    bool render_ = false;
+    double departure_time_ = 0.0;
+    Geo::Coordinates coords_;
+    size_t count_ = 0;
+    double radius_ = 0.0;
 };
 
-struct StatStop : public Stat {
-    StatStop(RequestType type = RequestType::Bus, int id = 0);
-    void MoveToHandler(RequestHander& handler) override;
+struct StatError {
+    int id_ = 0;
+};
 
-    const BusPtrsSet* buses_;
+struct StatStop {
+    int id_ = 0;
+    const BusPtrsSet* buses_ = nullptr;
 };
 
-struct StatBus : public RouteStatistics, public Stat {
-    StatBus(const RouteStatistics& parent, RequestType type = RequestType::Bus, int id = 0);
-    void MoveToHandler(RequestHander& handler) override;
+struct StatBus : public RouteStatistics {
+    StatBus(const RouteStatistics& parent, int id = 0);
+    int id_ = 0;
 };
 
-struct StatMap : public Stat {
-    StatMap(RequestType type = RequestType::Map, int id = 0);
+struct StatRoute : public RouteInfo {
+    StatRoute(RouteInfo&& parent, int id = 0);
+    int id_ = 0;
+};
+
+struct StatJourney : public JourneyInfo {
+    StatJourney(JourneyInfo&& parent, int id = 0);
+    int id_ = 0;
+};
+
+struct StatMap {
+    int id_ = 0;
     svg::Document map_;
 };
 
+struct StatIsochrone {
+    int id_ = 0;
+    std::vector<ReachableStop> stops_;
+    std::optional<svg::Document> map_;
+};
+
+struct StatNearbyStops {
+    int id_ = 0;
+    std::vector<NearbyStop> stops_;
+};
+
+struct StatNearbyBuses {
+    int id_ = 0;
+    std::vector<NearbyBus> buses_;
+};
+
+struct StatFragment {
+    int id_ = 0;
+    const std::string* fragment_ = nullptr;
+};
+
+struct StatDuplicate {
+    int id_ = 0;
+    size_t origin_ = 0;
+};
+
+using StatAnswer = std::variant<StatError, StatBus, StatStop, StatMap, StatRoute, StatIsochrone, StatJourney, StatNearbyStops, StatNearbyBuses, StatFragment, StatDuplicate>;
+
+class StatScheduler {
+public:
+    StatScheduler(size_t light_threads, size_t heavy_threads);
+    bool IsHeavy(RequestType type) const;
+    ThreadPool& GetLightPool();
+    ThreadPool& GetHeavyPool();
+    void Wait();
+
+private:
+    ThreadPool light_pool_;
+    ThreadPool heavy_pool_;
+};
+
 class RequestHander {
 public:
     RequestHander();
@@ -68,19 +136,45 @@ public:
     void AddRequest(RequestBaseStop&&  request_base_stop);
     void AddRequest(Stat&& request_stat);
     void ProvideInputRequests(TransportCatalogue& transport_c);
-    std::vector<std::shared_ptr<Stat>> GetStats(const TransportCatalogue& transport_c, 
+    void SetStatFragments(const StatFragments* fragments);
+    void SetRouter(const TransportRouter* router);
+    void SetRouteCache(RouteCache* route_cache, uint64_t version);
+    void SetTimetable(const Timetable* timetable);
+    void SetStopsIndex(const StopsIndex* stops_index);
+    void SetSegmentsIndex(const SegmentsIndex* segments_index);
+    std::vector<StatAnswer> GetStats(const TransportCatalogue& transport_c, 
         const std::optional<map_renderer::MapRenderer>& route_map = std::nullopt) const;
-private:
-    void PushBusStat(const TransportCatalogue& transport_c, 
-        const Stat& stat, 
-        std::vector<std::shared_ptr<Stat>>& container) const;
-    void PushStopStat(const TransportCatalogue& transport_c, 
-        const Stat& stat, 
-        std::vector<std::shared_ptr<Stat>>& container) const;
-    void PushMapStat(const map_renderer::MapRenderer& route_map, 
+    std::vector<StatAnswer> GetStatsParallel(const TransportCatalogue& transport_c, 
+        ThreadPool& pool,
+        const std::optional<map_renderer::MapRenderer>& route_map = std::nullopt) const;
+    std::vector<StatAnswer> GetStatsParallel(const TransportCatalogue& transport_c, 
+        StatScheduler& scheduler,
+        const std::optional<map_renderer::MapRenderer>& route_map = std::nullopt) const;
+    StatAnswer GetStat(const TransportCatalogue& transport_c, 
         const Stat& stat, 
-        std::vector<std::shared_ptr<Stat>>& container) const;
+        const std::optional<map_renderer::MapRenderer>& route_map = std::nullopt) const;
+private:
+    std::vector<size_t> FindRequestOrigins() const;
+    StatAnswer BuildBusStat(const TransportCatalogue& transport_c, 
+        const Stat& stat) const;
+    StatAnswer BuildStopStat(const TransportCatalogue& transport_c, 
+        const Stat& stat) const;
+    StatAnswer BuildMapStat(const map_renderer::MapRenderer& route_map, 
+        const Stat& stat) const;
+    StatAnswer BuildRouteStat(const Stat& stat) const;
+    StatAnswer BuildJourneyStat(const Stat& stat) const;
+    StatAnswer BuildNearbyStopsStat(const Stat& stat) const;
+    StatAnswer BuildNearbyBusesStat(const Stat& stat) const;
+    StatAnswer BuildIsochroneStat(const Stat& stat,
+        const std::optional<map_renderer::MapRenderer>& route_map) const;
     std::vector<RequestBaseStop> base_stop_requests_;
     std::vector<RequestBaseBus> base_bus_requests_;
     std::vector<Stat> stat_requests_;
+    const StatFragments* fragments_ = nullptr;
+    const TransportRouter* router_ = nullptr;
+    const Timetable* timetable_ = nullptr;
+    const StopsIndex* stops_index_ = nullptr;
+    const SegmentsIndex* segments_index_ = nullptr;
+    RouteCache* route_cache_ = nullptr;
+    uint64_t route_cache_version_ = 0;
 };
\ No newline at end of file
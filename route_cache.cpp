@@ -0,0 +1,108 @@
+#include "route_cache.h"
+#include <algorithm>
+
+using namespace std;
+
+RouteCache::RouteCache(size_t capacity, size_t shards_count) {
+    shards_count = max<size_t>(shards_count, 1);
+    shard_capacity_ = max<size_t>((capacity + shards_count - 1) / shards_count, 1);
+    shards_.reserve(shards_count);
+    for (size_t i = 0; i < shards_count; ++i) {
+        shards_.push_back(make_unique<Shard>());
+    }
+}
+
+optional<CachedRoute> RouteCache::Find(string_view from, string_view to, uint64_t version) {
+    AdvanceVersion(version);
+    Shard& shard = GetShard(from, to);
+    Key key{string(from), string(to), version};
+    {
+        lock_guard lock(shard.mutex_);
+        if (SyncVersion(shard, version)) {
+            auto it = shard.index_.find(key);
+            if (it != shard.index_.end()) {
+                shard.entries_.splice(shard.entries_.begin(), shard.entries_, it->second);
+                hits_.fetch_add(1, memory_order_relaxed);
+                return it->second->route_;
+            }
+        }
+    }
+    misses_.fetch_add(1, memory_order_relaxed);
+    return nullopt;
+}
+
+void RouteCache::Insert(string_view from, string_view to, uint64_t version, const CachedRoute& route) {
+    AdvanceVersion(version);
+    Shard& shard = GetShard(from, to);
+    Key key{string(from), string(to), version};
+    lock_guard lock(shard.mutex_);
+    if (!SyncVersion(shard, version)) {
+        return;
+    }
+
+    auto it = shard.index_.find(key);
+    if (it != shard.index_.end()) {
+        it->second->route_ = route;
+        shard.entries_.splice(shard.entries_.begin(), shard.entries_, it->second);
+        return;
+    }
+
+    if (shard.entries_.size() >= shard_capacity_) {
+        shard.index_.erase(shard.entries_.back().key_);
+        shard.entries_.pop_back();
+    }
+    shard.entries_.push_front({key, route});
+    shard.index_.emplace(move(key), shard.entries_.begin());
+}
+
+void RouteCache::Clear() {
+    for (auto& shard : shards_) {
+        lock_guard lock(shard->mutex_);
+        shard->index_.clear();
+        shard->entries_.clear();
+    }
+}
+
+RouteCacheStatistics RouteCache::GetStatistics() const {
+    RouteCacheStatistics statistics{hits_.load(memory_order_relaxed), misses_.load(memory_order_relaxed), 0};
+    for (const auto& shard : shards_) {
+        lock_guard lock(shard->mutex_);
+        statistics.size_ += shard->entries_.size();
+    }
+    return statistics;
+}
+
+size_t RouteCache::KeyHasher::operator()(const Key& key) const {
+    hash<string_view> hasher;
+    return (hasher(key.from_) * 37 + hasher(key.to_)) * 37 + hash<uint64_t>{}(key.version_);
+}
+
+RouteCache::Shard& RouteCache::GetShard(string_view from, string_view to) {
+    hash<string_view> hasher;
+    return *shards_[(hasher(from) * 37 + hasher(to)) % shards_.size()];
+}
+
+void RouteCache::AdvanceVersion(uint64_t version) {
+    uint64_t current = version_.load(memory_order_acquire);
+    if (version <= current) {
+        return;
+    }
+    for (auto& shard : shards_) {
+        lock_guard lock(shard->mutex_);
+        SyncVersion(*shard, version);
+    }
+    while (current < version && !version_.compare_exchange_weak(current, version, memory_order_acq_rel)) {
+    }
+}
+
+bool RouteCache::SyncVersion(Shard& shard, uint64_t version) {
+    if (version < shard.version_) {
+        return false;
+    }
+    if (version > shard.version_) {
+        shard.index_.clear();
+        shard.entries_.clear();
+        shard.version_ = version;
+    }
+    return true;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "transport_router.h"
+
+using CachedRoute = std::optional<RouteInfo>;
+
+struct RouteCacheStatistics {
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    size_t size_ = 0;
+};
+
+class RouteCache {
+public:
+    explicit RouteCache(size_t capacity, size_t shards_count = 16);
+    RouteCache(const RouteCache&) = delete;
+    RouteCache& operator=(const RouteCache&) = delete;
+
+    std::optional<CachedRoute> Find(std::string_view from, std::string_view to, uint64_t version);
+    void Insert(std::string_view from, std::string_view to, uint64_t version, const CachedRoute& route);
+    void Clear();
+    RouteCacheStatistics GetStatistics() const;
+
+private:
+    struct Key {
+        std::string from_;
+        std::string to_;
+        uint64_t version_ = 0;
+
+        bool operator==(const Key& other) const = default;
+    };
+
+    struct KeyHasher {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Entry {
+        Key key_;
+        CachedRoute route_;
+    };
+
+    struct Shard {
+        std::mutex mutex_;
+        std::list<Entry> entries_;
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHasher> index_;
+        uint64_t version_ = 0;
+    };
+
+    Shard& GetShard(std::string_view from, std::string_view to);
+    void AdvanceVersion(uint64_t version);
+    static bool SyncVersion(Shard& shard, uint64_t version);
+
+    size_t shard_capacity_ = 0;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<uint64_t> version_ = 0;
+    std::atomic<uint64_t> hits_ = 0;
+    std::atomic<uint64_t> misses_ = 0;
+};
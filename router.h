@@ -0,0 +1,106 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "graph.h"
+
+namespace graph {
+
+template <typename Weight>
+class Router {
+public:
+    struct RouteInfo {
+        Weight weight_{};
+        std::vector<EdgeId> edges_;
+    };
+
+    struct RoutesTree {
+        std::vector<Weight> weights_;
+        std::vector<EdgeId> prev_edges_;
+    };
+
+    static constexpr Weight UNREACHABLE = std::numeric_limits<Weight>::max();
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+    explicit Router(const DirectedWeightedGraph<Weight>& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    RoutesTree BuildTree(VertexId from, Weight limit = UNREACHABLE) const;
+
+private:
+    RoutesTree Search(VertexId from, VertexId to, Weight limit) const;
+
+    const DirectedWeightedGraph<Weight>& graph_;
+};
+
+template <typename Weight>
+Router<Weight>::Router(const DirectedWeightedGraph<Weight>& graph)
+    : graph_(graph) {}
+
+template <typename Weight>
+std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        return std::nullopt;
+    }
+
+    RoutesTree tree = Search(from, to, UNREACHABLE);
+    if (tree.weights_[to] == UNREACHABLE) {
+        return std::nullopt;
+    }
+
+    RouteInfo route{tree.weights_[to], {}};
+    for (VertexId vertex = to; vertex != from; vertex = graph_.GetEdge(tree.prev_edges_[vertex]).from_) {
+        route.edges_.push_back(tree.prev_edges_[vertex]);
+    }
+    std::reverse(route.edges_.begin(), route.edges_.end());
+    return route;
+}
+
+template <typename Weight>
+typename Router<Weight>::RoutesTree Router<Weight>::BuildTree(VertexId from, Weight limit) const {
+    if (from >= graph_.GetVertexCount()) {
+        return {std::vector<Weight>(graph_.GetVertexCount(), UNREACHABLE),
+            std::vector<EdgeId>(graph_.GetVertexCount(), NO_EDGE)};
+    }
+    return Search(from, graph_.GetVertexCount(), limit);
+}
+
+template <typename Weight>
+typename Router<Weight>::RoutesTree Router<Weight>::Search(VertexId from, VertexId to, Weight limit) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    RoutesTree tree{std::vector<Weight>(vertex_count, UNREACHABLE), std::vector<EdgeId>(vertex_count, NO_EDGE)};
+
+    using QueueItem = std::pair<Weight, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    tree.weights_[from] = Weight{};
+    queue.push({Weight{}, from});
+
+    while (!queue.empty()) {
+        auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (weight > tree.weights_[vertex]) {
+            continue;
+        }
+        if (vertex == to || weight > limit) {
+            break;
+        }
+        for (EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const Edge<Weight>& edge = graph_.GetEdge(edge_id);
+            const Weight new_weight = weight + edge.weight_;
+            if (new_weight < tree.weights_[edge.to_]) {
+                tree.weights_[edge.to_] = new_weight;
+                tree.prev_edges_[edge.to_] = edge_id;
+                queue.push({new_weight, edge.to_});
+            }
+        }
+    }
+    return tree;
+}
+
+}
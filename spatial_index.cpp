@@ -0,0 +1,437 @@
+#include "spatial_index.h"
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+using namespace std;
+
+namespace {
+
+const size_t DIMENSIONS = 3;
+const size_t NODE_CAPACITY = 16;
+const double CHORD_TOLERANCE = 1e-12;
+
+SpherePoint ToSpherePoint(Geo::Coordinates coords) {
+    static const double dr = PI / 180.;
+    const double lat = coords.lat * dr;
+    const double lng = coords.lng * dr;
+    return {{cos(lat) * cos(lng), cos(lat) * sin(lng), sin(lat)}};
+}
+
+double ComputeSquaredChord(const SpherePoint& lhs, const SpherePoint& rhs) {
+    double result = 0.0;
+    for (size_t axis = 0; axis < DIMENSIONS; ++axis) {
+        const double diff = lhs.axes_[axis] - rhs.axes_[axis];
+        result += diff * diff;
+    }
+    return result;
+}
+
+double ComputeSquaredRadiusChord(double radius) {
+    if (radius < 0.0) {
+        throw invalid_argument("Search radius must not be negative"s);
+    }
+    const double chord = 2.0 * sin(min(radius / EARTH_RADIUS, PI) / 2.0);
+    return chord * chord + CHORD_TOLERANCE;
+}
+
+double ChordToDistance(double squared_chord) {
+    return 2.0 * asin(min(sqrt(squared_chord) / 2.0, 1.0)) * EARTH_RADIUS;
+}
+
+SpherePoint ComputeCross(const SpherePoint& lhs, const SpherePoint& rhs) {
+    return {{lhs.axes_[1] * rhs.axes_[2] - lhs.axes_[2] * rhs.axes_[1],
+        lhs.axes_[2] * rhs.axes_[0] - lhs.axes_[0] * rhs.axes_[2],
+        lhs.axes_[0] * rhs.axes_[1] - lhs.axes_[1] * rhs.axes_[0]}};
+}
+
+double ComputeDot(const SpherePoint& lhs, const SpherePoint& rhs) {
+    return lhs.axes_[0] * rhs.axes_[0] + lhs.axes_[1] * rhs.axes_[1] + lhs.axes_[2] * rhs.axes_[2];
+}
+
+double ComputeArcSquaredChord(const SpherePoint& point, const SpherePoint& from, const SpherePoint& to) {
+    const double ends_chord = min(ComputeSquaredChord(point, from), ComputeSquaredChord(point, to));
+    const SpherePoint normal = ComputeCross(from, to);
+    const double normal_length = ComputeDot(normal, normal);
+    if (normal_length < CHORD_TOLERANCE) {
+        return ends_chord;
+    }
+
+    const double offset = ComputeDot(point, normal) / normal_length;
+    SpherePoint closest;
+    for (size_t axis = 0; axis < DIMENSIONS; ++axis) {
+        closest.axes_[axis] = point.axes_[axis] - normal.axes_[axis] * offset;
+    }
+    const double closest_length = sqrt(ComputeDot(closest, closest));
+    if (closest_length < CHORD_TOLERANCE) {
+        return ends_chord;
+    }
+    for (double& value : closest.axes_) {
+        value /= closest_length;
+    }
+    if (ComputeDot(ComputeCross(from, closest), normal) < 0.0 || ComputeDot(ComputeCross(closest, to), normal) < 0.0) {
+        return ends_chord;
+    }
+    return min(ends_chord, ComputeSquaredChord(point, closest));
+}
+
+}
+
+StopsIndex::StopsIndex(const vector<const Stop*>& stops) {
+    nodes_.reserve(stops.size());
+    for (const Stop* stop : stops) {
+        nodes_.push_back({ToSpherePoint(stop->GetCoordinates()), stop});
+    }
+    Rebuild();
+}
+
+vector<NearbyStop> StopsIndex::FindNearest(Geo::Coordinates point, size_t count) const {
+    if (count == 0) {
+        return {};
+    }
+    vector<Candidate> heap;
+    heap.reserve(min(count, positions_.size()));
+    const SpherePoint target = ToSpherePoint(point);
+    SearchNearest(target, count, 0, tree_size_, 0, heap);
+    for (size_t node = tree_size_; node < nodes_.size(); ++node) {
+        AddCandidate(target, count, static_cast<uint32_t>(node), heap);
+    }
+
+    vector<uint32_t> found;
+    found.reserve(heap.size());
+    for (const Candidate& candidate : heap) {
+        found.push_back(candidate.node_);
+    }
+    return MakeAnswer(target, found);
+}
+
+vector<NearbyStop> StopsIndex::FindWithinRadius(Geo::Coordinates point, double radius) const {
+    const double squared_chord = ComputeSquaredRadiusChord(radius);
+    const SpherePoint target = ToSpherePoint(point);
+    vector<uint32_t> found;
+    SearchWithinRadius(target, squared_chord, 0, tree_size_, 0, found);
+    for (size_t node = tree_size_; node < nodes_.size(); ++node) {
+        if (ComputeSquaredChord(target, nodes_[node].point_) <= squared_chord) {
+            found.push_back(static_cast<uint32_t>(node));
+        }
+    }
+    return MakeAnswer(target, found);
+}
+
+size_t StopsIndex::GetStopsCount() const {
+    return positions_.size();
+}
+
+void StopsIndex::MoveStop(const Stop* stop) {
+    auto it = positions_.find(stop);
+    if (it == positions_.end()) {
+        throw invalid_argument("Unknown stop: "s + stop->name_);
+    }
+    if (it->second >= tree_size_) {
+        nodes_[it->second].point_ = ToSpherePoint(stop->GetCoordinates());
+        return;
+    }
+
+    nodes_[it->second].stop_ = nullptr;
+    it->second = static_cast<uint32_t>(nodes_.size());
+    nodes_.push_back({ToSpherePoint(stop->GetCoordinates()), stop});
+    const size_t moved_limit = max(NODE_CAPACITY, static_cast<size_t>(sqrt(static_cast<double>(tree_size_))));
+    if (nodes_.size() - tree_size_ > moved_limit) {
+        Rebuild();
+    }
+}
+
+bool StopsIndex::Candidate::operator<(const Candidate& other) const {
+    return chord_ < other.chord_ || (chord_ == other.chord_ && node_ < other.node_);
+}
+
+void StopsIndex::Build(size_t begin, size_t end, size_t depth) {
+    if (end - begin < 2) {
+        return;
+    }
+    const size_t axis = depth % DIMENSIONS;
+    const size_t middle = begin + (end - begin) / 2;
+    nth_element(nodes_.begin() + begin, nodes_.begin() + middle, nodes_.begin() + end,
+        [axis](const Node& lhs, const Node& rhs) { return lhs.point_.axes_[axis] < rhs.point_.axes_[axis]; });
+    Build(begin, middle, depth + 1);
+    Build(middle + 1, end, depth + 1);
+}
+
+void StopsIndex::Rebuild() {
+    nodes_.erase(remove_if(nodes_.begin(), nodes_.end(), [](const Node& node) { return node.stop_ == nullptr; }),
+        nodes_.end());
+    tree_size_ = nodes_.size();
+    Build(0, tree_size_, 0);
+
+    positions_.clear();
+    positions_.reserve(nodes_.size());
+    for (size_t node = 0; node < nodes_.size(); ++node) {
+        positions_[nodes_[node].stop_] = static_cast<uint32_t>(node);
+    }
+}
+
+void StopsIndex::AddCandidate(const SpherePoint& point, size_t count, uint32_t node, vector<Candidate>& heap) const {
+    const Candidate candidate{ComputeSquaredChord(point, nodes_[node].point_), node};
+    if (heap.size() < count) {
+        heap.push_back(candidate);
+        push_heap(heap.begin(), heap.end());
+    } else if (candidate < heap.front()) {
+        pop_heap(heap.begin(), heap.end());
+        heap.back() = candidate;
+        push_heap(heap.begin(), heap.end());
+    }
+}
+
+void StopsIndex::SearchNearest(const SpherePoint& point, size_t count, size_t begin, size_t end, size_t depth,
+    vector<Candidate>& heap) const {
+    if (begin >= end) {
+        return;
+    }
+    const size_t middle = begin + (end - begin) / 2;
+    const Node& node = nodes_[middle];
+    if (node.stop_ != nullptr) {
+        AddCandidate(point, count, static_cast<uint32_t>(middle), heap);
+    }
+
+    const size_t axis = depth % DIMENSIONS;
+    const double diff = point.axes_[axis] - node.point_.axes_[axis];
+    if (diff < 0.0) {
+        SearchNearest(point, count, begin, middle, depth + 1, heap);
+        if (heap.size() < count || diff * diff <= heap.front().chord_) {
+            SearchNearest(point, count, middle + 1, end, depth + 1, heap);
+        }
+    } else {
+        SearchNearest(point, count, middle + 1, end, depth + 1, heap);
+        if (heap.size() < count || diff * diff <= heap.front().chord_) {
+            SearchNearest(point, count, begin, middle, depth + 1, heap);
+        }
+    }
+}
+
+void StopsIndex::SearchWithinRadius(const SpherePoint& point, double squared_chord, size_t begin, size_t end, size_t depth,
+    vector<uint32_t>& found) const {
+    if (begin >= end) {
+        return;
+    }
+    const size_t middle = begin + (end - begin) / 2;
+    const Node& node = nodes_[middle];
+    if (node.stop_ != nullptr && ComputeSquaredChord(point, node.point_) <= squared_chord) {
+        found.push_back(static_cast<uint32_t>(middle));
+    }
+
+    const size_t axis = depth % DIMENSIONS;
+    const double diff = point.axes_[axis] - node.point_.axes_[axis];
+    if (diff <= 0.0 || diff * diff <= squared_chord) {
+        SearchWithinRadius(point, squared_chord, begin, middle, depth + 1, found);
+    }
+    if (diff >= 0.0 || diff * diff <= squared_chord) {
+        SearchWithinRadius(point, squared_chord, middle + 1, end, depth + 1, found);
+    }
+}
+
+vector<NearbyStop> StopsIndex::MakeAnswer(const SpherePoint& point, const vector<uint32_t>& nodes) const {
+    vector<NearbyStop> result;
+    result.reserve(nodes.size());
+    for (uint32_t node : nodes) {
+        result.push_back({nodes_[node].stop_, ChordToDistance(ComputeSquaredChord(point, nodes_[node].point_))});
+    }
+    sort(result.begin(), result.end(), [](const NearbyStop& lhs, const NearbyStop& rhs) {
+        return lhs.distance_ < rhs.distance_ || (lhs.distance_ == rhs.distance_ && lhs.stop_->name_ < rhs.stop_->name_);
+    });
+    return result;
+}
+
+SegmentsIndex::SegmentsIndex(const vector<const Bus*>& buses) {
+    for (const Bus* bus : buses) {
+        AddBusSegments(bus);
+    }
+    Rebuild();
+}
+
+vector<NearbyBus> SegmentsIndex::FindBusesWithinRadius(Geo::Coordinates point, double radius) const {
+    const double squared_chord = ComputeSquaredRadiusChord(radius);
+    const SpherePoint target = ToSpherePoint(point);
+
+    unordered_map<const Bus*, double> closest;
+    vector<pair<uint32_t, size_t>> pending;
+    if (!nodes_.empty()) {
+        pending.push_back({static_cast<uint32_t>(nodes_.size() - 1), levels_offsets_.size() - 2});
+    }
+    while (!pending.empty()) {
+        const auto [node_index, level] = pending.back();
+        pending.pop_back();
+        const Node& node = nodes_[node_index];
+        for (uint32_t child = node.first_; child < node.first_ + node.count_; ++child) {
+            if (level != 0) {
+                if (ComputeBoxSquaredChord(target, nodes_[child].box_) <= squared_chord) {
+                    pending.push_back({child, level - 1});
+                }
+                continue;
+            }
+            AddCloseBus(target, squared_chord, segments_[child], closest);
+        }
+    }
+    for (size_t segment = tree_size_; segment < segments_.size(); ++segment) {
+        AddCloseBus(target, squared_chord, segments_[segment], closest);
+    }
+
+    vector<NearbyBus> result;
+    result.reserve(closest.size());
+    for (const auto& [bus, bus_chord] : closest) {
+        result.push_back({bus, ChordToDistance(bus_chord)});
+    }
+    sort(result.begin(), result.end(), [](const NearbyBus& lhs, const NearbyBus& rhs) {
+        return lhs.distance_ < rhs.distance_ || (lhs.distance_ == rhs.distance_ && lhs.bus_->name_ < rhs.bus_->name_);
+    });
+    return result;
+}
+
+size_t SegmentsIndex::GetSegmentsCount() const {
+    return segments_.size() - removed_count_;
+}
+
+void SegmentsIndex::UpdateBus(const Bus* bus) {
+    RemoveBusSegments(bus);
+    AddBusSegments(bus);
+    RebuildIfStale();
+}
+
+void SegmentsIndex::RemoveBus(const Bus* bus) {
+    RemoveBusSegments(bus);
+    RebuildIfStale();
+}
+
+void SegmentsIndex::RemoveBusSegments(const Bus* bus) {
+    auto it = positions_.find(bus);
+    if (it == positions_.end()) {
+        return;
+    }
+    for (uint32_t segment : it->second) {
+        segments_[segment].bus_ = nullptr;
+    }
+    removed_count_ += it->second.size();
+    positions_.erase(it);
+}
+
+void SegmentsIndex::AddBusSegments(const Bus* bus) {
+    const vector<Stop*>& route = bus->route_;
+    if (route.empty()) {
+        return;
+    }
+    vector<uint32_t>& positions = positions_[bus];
+    set<pair<const Stop*, const Stop*>> added;
+    for (size_t i = 0; i + 1 < max<size_t>(route.size(), 2); ++i) {
+        const Stop* from = route[i];
+        const Stop* to = route[min(i + 1, route.size() - 1)];
+        if (!added.insert(minmax(from, to)).second) {
+            continue;
+        }
+        Segment segment{ToSpherePoint(from->GetCoordinates()), ToSpherePoint(to->GetCoordinates()), {}, bus};
+        const double sagitta = 1.0 - sqrt(max(0.0, 1.0 - ComputeSquaredChord(segment.from_, segment.to_) / 4.0));
+        for (size_t axis = 0; axis < DIMENSIONS; ++axis) {
+            segment.box_.min_.axes_[axis] = min(segment.from_.axes_[axis], segment.to_.axes_[axis]) - sagitta;
+            segment.box_.max_.axes_[axis] = max(segment.from_.axes_[axis], segment.to_.axes_[axis]) + sagitta;
+        }
+        positions.push_back(static_cast<uint32_t>(segments_.size()));
+        segments_.push_back(segment);
+    }
+}
+
+void SegmentsIndex::AddCloseBus(const SpherePoint& point, double squared_chord, const Segment& segment,
+    unordered_map<const Bus*, double>& closest) const {
+    if (segment.bus_ == nullptr || ComputeBoxSquaredChord(point, segment.box_) > squared_chord) {
+        return;
+    }
+    const double segment_chord = ComputeArcSquaredChord(point, segment.from_, segment.to_);
+    if (segment_chord > squared_chord) {
+        return;
+    }
+    auto [it, inserted] = closest.try_emplace(segment.bus_, segment_chord);
+    if (!inserted) {
+        it->second = min(it->second, segment_chord);
+    }
+}
+
+void SegmentsIndex::RebuildIfStale() {
+    const size_t added_limit = max(NODE_CAPACITY, static_cast<size_t>(sqrt(static_cast<double>(tree_size_))));
+    if (segments_.size() - tree_size_ > added_limit || removed_count_ * 2 > segments_.size()) {
+        Rebuild();
+    }
+}
+
+void SegmentsIndex::Rebuild() {
+    segments_.erase(remove_if(segments_.begin(), segments_.end(),
+        [](const Segment& segment) { return segment.bus_ == nullptr; }), segments_.end());
+    removed_count_ = 0;
+    tree_size_ = segments_.size();
+    SortTileRecursive(0, tree_size_, 0);
+    BuildLevels();
+
+    positions_.clear();
+    for (size_t segment = 0; segment < segments_.size(); ++segment) {
+        positions_[segments_[segment].bus_].push_back(static_cast<uint32_t>(segment));
+    }
+}
+
+double SegmentsIndex::ComputeBoxSquaredChord(const SpherePoint& point, const Box& box) {
+    double result = 0.0;
+    for (size_t axis = 0; axis < DIMENSIONS; ++axis) {
+        const double diff = max({box.min_.axes_[axis] - point.axes_[axis], 0.0, point.axes_[axis] - box.max_.axes_[axis]});
+        result += diff * diff;
+    }
+    return result;
+}
+
+void SegmentsIndex::SortTileRecursive(size_t begin, size_t end, size_t axis) {
+    sort(segments_.begin() + begin, segments_.begin() + end, [axis](const Segment& lhs, const Segment& rhs) {
+        return lhs.box_.min_.axes_[axis] + lhs.box_.max_.axes_[axis] < rhs.box_.min_.axes_[axis] + rhs.box_.max_.axes_[axis];
+    });
+    if (axis + 1 == DIMENSIONS) {
+        return;
+    }
+    const size_t leaves = (end - begin + NODE_CAPACITY - 1) / NODE_CAPACITY;
+    const size_t slices = max<size_t>(1, static_cast<size_t>(ceil(pow(static_cast<double>(leaves), 1.0 / (DIMENSIONS - axis)))));
+    const size_t slice_size = (leaves + slices - 1) / slices * NODE_CAPACITY;
+    for (size_t slice = begin; slice < end; slice += slice_size) {
+        SortTileRecursive(slice, min(end, slice + slice_size), axis + 1);
+    }
+}
+
+void SegmentsIndex::BuildLevels() {
+    nodes_.clear();
+    levels_offsets_ = {0};
+    if (tree_size_ == 0) {
+        return;
+    }
+
+    auto add_node = [this](uint32_t first, uint32_t count, auto get_box) {
+        Node node{get_box(first), first, count};
+        for (uint32_t child = first + 1; child < first + count; ++child) {
+            const Box box = get_box(child);
+            for (size_t axis = 0; axis < DIMENSIONS; ++axis) {
+                node.box_.min_.axes_[axis] = min(node.box_.min_.axes_[axis], box.min_.axes_[axis]);
+                node.box_.max_.axes_[axis] = max(node.box_.max_.axes_[axis], box.max_.axes_[axis]);
+            }
+        }
+        nodes_.push_back(node);
+    };
+
+    for (size_t first = 0; first < tree_size_; first += NODE_CAPACITY) {
+        const size_t count = min(NODE_CAPACITY, tree_size_ - first);
+        add_node(static_cast<uint32_t>(first), static_cast<uint32_t>(count),
+            [this](uint32_t child) { return segments_[child].box_; });
+    }
+    levels_offsets_.push_back(static_cast<uint32_t>(nodes_.size()));
+
+    while (levels_offsets_.back() - levels_offsets_[levels_offsets_.size() - 2] > 1) {
+        const uint32_t level_begin = levels_offsets_[levels_offsets_.size() - 2];
+        const uint32_t level_end = levels_offsets_.back();
+        for (uint32_t first = level_begin; first < level_end; first += NODE_CAPACITY) {
+            const uint32_t count = min<uint32_t>(NODE_CAPACITY, level_end - first);
+            add_node(first, count, [this](uint32_t child) { return nodes_[child].box_; });
+        }
+        levels_offsets_.push_back(static_cast<uint32_t>(nodes_.size()));
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "domain.h"
+#include "geo.h"
+
+struct SpherePoint {
+    double axes_[3] = {0.0, 0.0, 0.0};
+};
+
+struct NearbyStop {
+    const Stop* stop_ = nullptr;
+    double distance_ = 0.0;
+};
+
+class StopsIndex {
+public:
+    StopsIndex() = default;
+    explicit StopsIndex(const std::vector<const Stop*>& stops);
+
+    std::vector<NearbyStop> FindNearest(Geo::Coordinates point, size_t count) const;
+    std::vector<NearbyStop> FindWithinRadius(Geo::Coordinates point, double radius) const;
+    size_t GetStopsCount() const;
+    void MoveStop(const Stop* stop);
+
+private:
+    struct Node {
+        SpherePoint point_;
+        const Stop* stop_ = nullptr;
+    };
+
+    struct Candidate {
+        double chord_ = 0.0;
+        uint32_t node_ = 0;
+
+        bool operator<(const Candidate& other) const;
+    };
+
+    void Build(size_t begin, size_t end, size_t depth);
+    void Rebuild();
+    void AddCandidate(const SpherePoint& point, size_t count, uint32_t node, std::vector<Candidate>& heap) const;
+    void SearchNearest(const SpherePoint& point, size_t count, size_t begin, size_t end, size_t depth,
+        std::vector<Candidate>& heap) const;
+    void SearchWithinRadius(const SpherePoint& point, double squared_chord, size_t begin, size_t end, size_t depth,
+        std::vector<uint32_t>& found) const;
+    std::vector<NearbyStop> MakeAnswer(const SpherePoint& point, const std::vector<uint32_t>& nodes) const;
+
+    std::vector<Node> nodes_;
+    size_t tree_size_ = 0;
+    std::unordered_map<const Stop*, uint32_t> positions_;
+};
+
+struct NearbyBus {
+    const Bus* bus_ = nullptr;
+    double distance_ = 0.0;
+};
+
+class SegmentsIndex {
+public:
+    SegmentsIndex() = default;
+    explicit SegmentsIndex(const std::vector<const Bus*>& buses);
+
+    std::vector<NearbyBus> FindBusesWithinRadius(Geo::Coordinates point, double radius) const;
+    size_t GetSegmentsCount() const;
+    void UpdateBus(const Bus* bus);
+    void RemoveBus(const Bus* bus);
+
+private:
+    struct Box {
+        SpherePoint min_;
+        SpherePoint max_;
+    };
+
+    struct Segment {
+        SpherePoint from_;
+        SpherePoint to_;
+        Box box_;
+        const Bus* bus_ = nullptr;
+    };
+
+    struct Node {
+        Box box_;
+        uint32_t first_ = 0;
+        uint32_t count_ = 0;
+    };
+
+    static double ComputeBoxSquaredChord(const SpherePoint& point, const Box& box);
+
+    void AddBusSegments(const Bus* bus);
+    void RemoveBusSegments(const Bus* bus);
+    void AddCloseBus(const SpherePoint& point, double squared_chord, const Segment& segment,
+        std::unordered_map<const Bus*, double>& closest) const;
+    void RebuildIfStale();
+    void Rebuild();
+    void SortTileRecursive(size_t begin, size_t end, size_t axis);
+    void BuildLevels();
+
+    std::vector<Segment> segments_;
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> levels_offsets_;
+    size_t tree_size_ = 0;
+    size_t removed_count_ = 0;
+    std::unordered_map<const Bus*, std::vector<uint32_t>> positions_;
+};
@@ -0,0 +1,159 @@
+#include "stat_fragments.h"
+#include <sstream>
+
+#include "json.h"
+
+using namespace std;
+
+void WriteBusFragment(const RouteStatistics& statistics, ostream& out) {
+    out << "\"curvature\" : ";
+    json::NodePrinter{out}(statistics.curvature_);
+    out << ", \"route_length\" : ";
+    json::NodePrinter{out}(statistics.route_length_);
+    out << ", \"stop_count\" : " << statistics.stops_count_
+        << ", \"unique_stop_count\" : " << statistics.unique_stops_count_ << '}';
+}
+
+void WriteStopFragment(const BusPtrsSet* buses, ostream& out) {
+    out << "\"buses\" : [";
+    if (buses != nullptr) {
+        bool first = true;
+        for (const Bus* bus : *buses) {
+            if (!first) {
+                out << ", ";
+            }
+            json::NodePrinter{out}(bus->name_);
+            first = false;
+        }
+    }
+    out << "]}";
+}
+
+void WriteRouteFragment(const RouteInfo& route, ostream& out) {
+    out << "\"items\" : [";
+    bool first = true;
+    for (const RouteItem& item : route.items_) {
+        if (!first) {
+            out << ", ";
+        }
+        if (const RouteWait* wait = get_if<RouteWait>(&item)) {
+            out << "{\"stop_name\" : ";
+            json::NodePrinter{out}(wait->stop_->name_);
+            out << ", \"time\" : ";
+            json::NodePrinter{out}(wait->time_);
+            out << ", \"type\" : \"Wait\"}";
+        } else {
+            const RouteRide& ride = get<RouteRide>(item);
+            out << "{\"bus\" : ";
+            json::NodePrinter{out}(ride.bus_->name_);
+            out << ", \"span_count\" : " << ride.span_count_ << ", \"time\" : ";
+            json::NodePrinter{out}(ride.time_);
+            out << ", \"type\" : \"Bus\"}";
+        }
+        first = false;
+    }
+    out << "], \"total_time\" : ";
+    json::NodePrinter{out}(route.total_time_);
+    out << '}';
+}
+
+void WriteIsochroneFragment(const vector<ReachableStop>& stops, ostream& out) {
+    out << "\"stops\" : [";
+    bool first = true;
+    for (const ReachableStop& reachable : stops) {
+        if (!first) {
+            out << ", ";
+        }
+        out << "{\"stop_name\" : ";
+        json::NodePrinter{out}(reachable.stop_->name_);
+        out << ", \"time\" : ";
+        json::NodePrinter{out}(reachable.time_);
+        out << '}';
+        first = false;
+    }
+    out << "]}";
+}
+
+void WriteNearbyStopsFragment(const vector<NearbyStop>& stops, ostream& out) {
+    out << "\"stops\" : [";
+    bool first = true;
+    for (const NearbyStop& nearby : stops) {
+        if (!first) {
+            out << ", ";
+        }
+        out << "{\"distance\" : ";
+        json::NodePrinter{out}(nearby.distance_);
+        out << ", \"stop_name\" : ";
+        json::NodePrinter{out}(nearby.stop_->name_);
+        out << '}';
+        first = false;
+    }
+    out << "]}";
+}
+
+void WriteNearbyBusesFragment(const vector<NearbyBus>& buses, ostream& out) {
+    out << "\"buses\" : [";
+    bool first = true;
+    for (const NearbyBus& nearby : buses) {
+        if (!first) {
+            out << ", ";
+        }
+        out << "{\"bus\" : ";
+        json::NodePrinter{out}(nearby.bus_->name_);
+        out << ", \"distance\" : ";
+        json::NodePrinter{out}(nearby.distance_);
+        out << '}';
+        first = false;
+    }
+    out << "]}";
+}
+
+StatFragments::StatFragments(const TransportCatalogue& transport_c) {
+    for (const Bus* bus : transport_c.GetAllBuses()) {
+        UpdateBus(transport_c, bus->name_);
+    }
+    for (const Stop* stop : transport_c.GetAllStops()) {
+        UpdateStop(transport_c, stop->name_);
+    }
+}
+
+const string* StatFragments::FindBus(string_view bus) const {
+    auto it = buses_.find(bus);
+    if (it == buses_.end()) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+const string* StatFragments::FindStop(string_view stop) const {
+    auto it = stops_.find(stop);
+    if (it == stops_.end()) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+void StatFragments::UpdateBus(const TransportCatalogue& transport_c, string_view bus) {
+    optional<RouteStatistics> statistics = transport_c.GetRouteStatistics(bus);
+    if (!statistics) {
+        if (auto it = buses_.find(bus); it != buses_.end()) {
+            buses_.erase(it);
+        }
+        return;
+    }
+    ostringstream fragment;
+    WriteBusFragment(*statistics, fragment);
+    buses_.insert_or_assign(string(bus), fragment.str());
+}
+
+void StatFragments::UpdateStop(const TransportCatalogue& transport_c, string_view stop) {
+    if (transport_c.FindStop(stop) == nullptr) {
+        if (auto it = stops_.find(stop); it != stops_.end()) {
+            stops_.erase(it);
+        }
+        return;
+    }
+    ostringstream fragment;
+    WriteStopFragment(transport_c.FindBuses(stop), fragment);
+    stops_.insert_or_assign(string(stop), fragment.str());
+}
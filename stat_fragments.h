@@ -0,0 +1,40 @@
+#pragma once
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "transport_catalogue.h"
+#include "transport_router.h"
+#include "spatial_index.h"
+
+void WriteBusFragment(const RouteStatistics& statistics, std::ostream& out);
+void WriteStopFragment(const BusPtrsSet* buses, std::ostream& out);
+void WriteRouteFragment(const RouteInfo& route, std::ostream& out);
+void WriteIsochroneFragment(const std::vector<ReachableStop>& stops, std::ostream& out);
+void WriteNearbyStopsFragment(const std::vector<NearbyStop>& stops, std::ostream& out);
+void WriteNearbyBusesFragment(const std::vector<NearbyBus>& buses, std::ostream& out);
+
+class StatFragments {
+public:
+    StatFragments() = default;
+    explicit StatFragments(const TransportCatalogue& transport_c);
+
+    const std::string* FindBus(std::string_view bus) const;
+    const std::string* FindStop(std::string_view stop) const;
+
+    void UpdateBus(const TransportCatalogue& transport_c, std::string_view bus);
+    void UpdateStop(const TransportCatalogue& transport_c, std::string_view stop);
+
+private:
+    struct NameHasher {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const {
+            return std::hash<std::string_view>{}(name);
+        }
+    };
+    using FragmentsMap = std::unordered_map<std::string, std::string, NameHasher, std::equal_to<>>;
+
+    FragmentsMap buses_;
+    FragmentsMap stops_;
+};
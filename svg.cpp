@@ -1,6 +1,7 @@
 #define _USE_MATH_DEFINES 
 #include <cmath>
 #include <sstream>
+#include <stdexcept>
 
 #include "svg.h"
 
@@ -18,6 +19,30 @@ ostream& operator <<(ostream& out, const Color& color) {
     return out;
 }
 
+ColorTable::ColorTable() {
+    Intern(monostate{});
+}
+
+ColorId ColorTable::Intern(const Color& color) {
+    ostringstream text;
+    if (!holds_alternative<monostate>(color)) {
+        text << color;
+    }
+    auto [it, inserted] = ids_.try_emplace(text.str(), static_cast<ColorId>(serialized_.size()));
+    if (inserted) {
+        serialized_.push_back(it->first);
+    }
+    return it->second;
+}
+
+const string& ColorTable::Get(ColorId id) const {
+    return serialized_.at(static_cast<size_t>(id));
+}
+
+size_t ColorTable::Size() const {
+    return serialized_.size();
+}
+
 ostream &operator<<(ostream &out, const Rgb &color) {
     out << "rgb(" << unsigned(color.red) << ',' << unsigned(color.green) << ',' << unsigned(color.blue) << ')';
     return out;
@@ -174,8 +199,12 @@ void Document::AddObjectPtr(std::unique_ptr<Object>&& obj_ptr) {
     objects_ptrs_.push_back(move(obj_ptr));
 }
 
+void Document::SetColorTable(std::shared_ptr<const ColorTable> colors) {
+    colors_ = move(colors);
+}
+
 void Document::Render(std::ostream& out) const {
-    RenderContext props(out, 1, 2);
+    RenderContext props(out, 1, 2, colors_.get());
     props << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n"s;
     props << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">\n"s;
 
@@ -238,14 +267,15 @@ RenderContext::RenderContext(ostream& out)
     : value_(out) {
 }
 
-RenderContext::RenderContext(ostream& out, int indent_step, int indent)
+RenderContext::RenderContext(ostream& out, int indent_step, int indent, const ColorTable* colors)
     : value_(out)
     , indent_step(indent_step)
-    , indent(indent) {
+    , indent(indent)
+    , colors_(colors) {
 }
 
 RenderContext RenderContext::Indented() const {
-    return {value_, indent_step, indent + indent_step};
+    return {value_, indent_step, indent + indent_step, colors_};
 }
 
 void RenderContext::RenderIndent() const {
@@ -254,4 +284,11 @@ void RenderContext::RenderIndent() const {
     }
 }
 
+const string& RenderContext::GetColor(ColorId id) const {
+    if (colors_ == nullptr) {
+        throw logic_error("Color id is used without a color table"s);
+    }
+    return colors_->Get(id);
+}
+
 }
\ No newline at end of file
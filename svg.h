@@ -9,6 +9,7 @@
 #include <limits>
 #include <type_traits>
 #include <sstream>
+#include <unordered_map>
 
 namespace svg {
 
@@ -68,6 +69,24 @@ inline const Color NoneColor{"none"};
 
 std::ostream& operator <<(std::ostream& out, const Color& color);
 
+enum class ColorId : uint32_t {};
+
+// Unset color is interned as an empty string and is not written
+inline constexpr ColorId UnsetColor{};
+
+class ColorTable {
+public:
+    ColorTable();
+
+    ColorId Intern(const Color& color);
+    const std::string& Get(ColorId id) const;
+    size_t Size() const;
+
+private:
+    std::vector<std::string> serialized_;
+    std::unordered_map<std::string, ColorId> ids_;
+};
+
 inline bool IsEqualDouble(double l, double r);
 
 struct Point {
@@ -79,9 +98,10 @@ struct Point {
 
 struct RenderContext {
     RenderContext(std::ostream& out);
-    RenderContext(std::ostream& out, int indent_step, int indent = 0);
+    RenderContext(std::ostream& out, int indent_step, int indent = 0, const ColorTable* colors = nullptr);
     RenderContext Indented() const;
     void RenderIndent() const; 
+    const std::string& GetColor(ColorId id) const;
 
     template <ToOstream T>
     RenderContext& operator <<(const T& value) {
@@ -93,6 +113,7 @@ private:
     std::ostream& value_;
     int indent_step = 0;
     int indent = 0; 
+    const ColorTable* colors_ = nullptr;
 };
 
 template <ToOstream ValueType>
@@ -128,27 +149,34 @@ private:
 template<typename Owner>
 class ObjectProperties {
 public:
-    Owner& SetFillColor(const Color& color) {fill_color_ = color; return AsOwner();}
-    Owner& SetStrokeColor(const Color& color) {stroke_color_ = color; return AsOwner();}
+    Owner& SetFillColor(ColorId color) {fill_color_ = color; return AsOwner();}
+    Owner& SetStrokeColor(ColorId color) {stroke_color_ = color; return AsOwner();}
     Owner& SetStrokeWidth(double width) {stroke_width_ = width; return AsOwner();}
     Owner& SetStrokeLineCap(StrokeLineCap line_cap) {line_cap_ = line_cap; return AsOwner();}
     Owner& SetStrokeLineJoin(StrokeLineJoin line_join) {line_join_ = line_join; return AsOwner();}
 protected:
     void WriteBasicAttrs(RenderContext& out) const {
-        WriteAttribute<const Color&>(out, {"fill", fill_color_}, !holds_alternative<std::monostate>(fill_color_));
-        WriteAttribute<const Color&>(out, {"stroke", stroke_color_}, !holds_alternative<std::monostate>(stroke_color_));
+        WriteColorAttr(out, "fill", fill_color_);
+        WriteColorAttr(out, "stroke", stroke_color_);
         WriteAttribute<double>(out, {"stroke-width", stroke_width_}, !IsEqualDouble(stroke_width_, 0.0));
         WriteAttribute<StrokeLineCap> (out, {"stroke-linecap", line_cap_}, line_cap_ != StrokeLineCap::NONE);
         WriteAttribute<StrokeLineJoin> (out, {"stroke-linejoin", line_join_}, line_join_ != StrokeLineJoin::NONE);
     }
 
-    Color fill_color_;
-    Color stroke_color_;
+    ColorId fill_color_ = UnsetColor;
+    ColorId stroke_color_ = UnsetColor;
     double stroke_width_ = 0.0;
     StrokeLineCap line_cap_ = StrokeLineCap::NONE;
     StrokeLineJoin line_join_ = StrokeLineJoin::NONE;
 
 private:
+    static void WriteColorAttr(RenderContext& out, const std::string& name, ColorId color) {
+        if (color == UnsetColor) {
+            return;
+        }
+        WriteAttribute<const std::string&>(out, {name, out.GetColor(color)});
+    }
+
     Owner& AsOwner() {
         return static_cast<Owner&>(*this);
     }
@@ -211,6 +239,7 @@ public:
         AddObjectPtr(std::make_unique<T>(std::move(object)));
     }
     virtual void AddObjectPtr(std::unique_ptr<Object>&& object_ptr) = 0;
+    virtual void SetColorTable(std::shared_ptr<const ColorTable> colors) = 0;
 
     virtual ~ObjectContainer() = default;
 };
@@ -218,10 +247,12 @@ public:
 class Document : public ObjectContainer {
 public:
     void AddObjectPtr(std::unique_ptr<Object>&& obj_ptr) override;
+    void SetColorTable(std::shared_ptr<const ColorTable> colors) override;
     void Render(std::ostream& out) const;
 
 private:
     std::vector<std::unique_ptr<Object>> objects_ptrs_;
+    std::shared_ptr<const ColorTable> colors_;
 };
 
 class Drawable {
@@ -24,13 +24,16 @@ DEFINE_TEST_GF(AddStop_Testing, TransportCatalogue_Tests, ExceptionFixture) {
     string name_3("Stop_3");
 
     (catalogue.AddStop(name_1, coord_1));
-    TEST((*catalogue.FindStop(name_1) == Stop(name_1, Coordinates(0.1, 0.1)) ));
+    TEST((*catalogue.FindStop(name_1) == Stop(name_1) ));
+    TEST((catalogue.FindStop(name_1)->GetCoordinates() == Coordinates(0.1, 0.1)));
 
     catalogue.AddStop(name_2, coord_2);
     catalogue.AddStop(name_3, coord_3);
 
-    TEST((*catalogue.FindStop(name_2) == Stop(name_2, Coordinates(0.2, 0.2)) ));
-    TEST((*catalogue.FindStop(name_3) == Stop(name_3, Coordinates(0.3, 0.3)) ));
+    TEST((*catalogue.FindStop(name_2) == Stop(name_2) ));
+    TEST((catalogue.FindStop(name_2)->GetCoordinates() == Coordinates(0.2, 0.2)));
+    TEST((*catalogue.FindStop(name_3) == Stop(name_3) ));
+    TEST((catalogue.FindStop(name_3)->GetCoordinates() == Coordinates(0.3, 0.3)));
 };
 
 DEFINE_TEST_GF(AddBus_Testing, TransportCatalogue_Tests, ExceptionFixture) {
@@ -77,7 +80,7 @@ DEFINE_TEST_G(GetCountUniqueStops_UniqueStopsOnly, TransportCatalogue_Tests)
     tc.AddBus("Bus1", 
     vector<string_view>(str.begin(), str.end()));
 
-    RouteStatistics stat = tc.GetRouteStatistics("Bus1"s);
+    RouteStatistics stat = tc.GetRouteStatistics("Bus1"s).value();
 
     TEST_EQ(stat.unique_stops_count_, (size_t)3);
 }
@@ -93,7 +96,7 @@ DEFINE_TEST_G(GetCountUniqueStops_RepeatedStops, TransportCatalogue_Tests)
     tc.AddBus("Bus1", 
     vector<string_view>(str.begin(), str.end()));
 
-    RouteStatistics stat = tc.GetRouteStatistics("Bus1"s);
+    RouteStatistics stat = tc.GetRouteStatistics("Bus1"s).value();
 
     TEST_EQ(stat.unique_stops_count_, (size_t)2);
 }
@@ -107,7 +110,7 @@ DEFINE_TEST_G(GetCountUniqueStops_SingleStop, TransportCatalogue_Tests)
     tc.AddBus("Bus1", 
         vector<string_view>({"Stop1"sv}));
 
-    RouteStatistics stat = tc.GetRouteStatistics("Bus1"s);
+    RouteStatistics stat = tc.GetRouteStatistics("Bus1"s).value();
 
     TEST_EQ(stat.unique_stops_count_, (size_t)1);
 }
@@ -118,7 +121,7 @@ DEFINE_TEST_G(GetCountUniqueStops_EmptyRoute, TransportCatalogue_Tests)
 
     tc.AddBus("Bus1", vector<string_view>());
 
-    RouteStatistics stat = tc.GetRouteStatistics("Bus1"s);
+    RouteStatistics stat = tc.GetRouteStatistics("Bus1"s).value();
 
     TEST_EQ(stat.unique_stops_count_, (size_t)0);
 }
@@ -312,4 +315,127 @@ DEFINE_TEST_G(GetRealRouteLength_SingleStop, TransportCatalogue_Tests) {
     TEST_EQ(catalogue.GetRealRouteLength("SingleStopBus"), 0);
 }
 
+DEFINE_TEST_G(RemoveBus_Testing, TransportCatalogue_Tests) {
+    TransportCatalogue_Testing catalogue;
+
+    catalogue.AddStop("A", {55.0, 37.0});
+    catalogue.AddStop("B", {55.1, 37.1});
+    catalogue.AddStop("C", {55.2, 37.2});
+
+    catalogue.AddBus("Bus1", {"A", "B"});
+    catalogue.AddBus("Bus2", {"B", "C"});
+
+    catalogue.RemoveBus("Bus1");
+
+    TEST(catalogue.FindBus("Bus1") == nullptr);
+    TEST(!catalogue.GetRouteStatistics("Bus1").has_value());
+    TEST(catalogue.FindBuses("A") == nullptr);
+    TEST_EQ(catalogue.FindBuses("B")->size(), 1);
+    TEST_EQ((*catalogue.FindBuses("B")->begin())->name_, "Bus2"s);
+    TEST_EQ(catalogue.GetAllBuses().size(), 1);
+}
+
+DEFINE_TEST_G(UpdateBusRoute_Testing, TransportCatalogue_Tests) {
+    TransportCatalogue_Testing catalogue;
+
+    catalogue.AddStop("A", {55.0, 37.0});
+    catalogue.AddStop("B", {55.1, 37.1});
+    catalogue.AddStop("C", {55.2, 37.2});
+
+    catalogue.AddNeighborStopDistance("A"sv, "B"sv, 100);
+    catalogue.AddNeighborStopDistance("A"sv, "C"sv, 400);
+
+    catalogue.AddBus("Bus1", {"A", "B"});
+    const Bus* bus = catalogue.FindBus("Bus1");
+
+    catalogue.UpdateBusRoute("Bus1", {"A", "C", "A"}, true);
+
+    TEST(catalogue.FindBus("Bus1") == bus);
+    TEST(bus->is_round_);
+    TEST(catalogue.FindBuses("B") == nullptr);
+    TEST(catalogue.FindBuses("C")->contains(bus));
+
+    RouteStatistics stat = catalogue.GetRouteStatistics("Bus1").value();
+    TEST_EQ(stat.stops_count_, 3);
+    TEST_EQ(stat.unique_stops_count_, 2);
+    TEST_EQ(stat.route_length_, 800);
+}
+
+DEFINE_TEST_G(MoveStop_And_UpdateDistance_Testing, TransportCatalogue_Tests) {
+    TransportCatalogue_Testing catalogue;
+
+    catalogue.AddStop("A", {55.0, 37.0});
+    catalogue.AddStop("B", {55.1, 37.1});
+
+    catalogue.AddNeighborStopDistance("A"sv, "B"sv, 20000);
+    catalogue.AddBus("Bus1", {"A", "B", "A"});
+
+    catalogue.UpdateDistance("B", "A", 30000);
+    catalogue.MoveStop("B", {55.2, 37.2});
+
+    double geo_length = 2 * ComputeDistance({55.0, 37.0}, {55.2, 37.2});
+    RouteStatistics stat = catalogue.GetRouteStatistics("Bus1").value();
+    TEST_EQ(stat.route_length_, 50000);
+    TEST(IsEqualDouble(stat.curvature_, 50000 / geo_length));
+
+    bool is_thrown = false;
+    try {
+        catalogue.MoveStop("Unknown", {0.0, 0.0});
+    } catch (const invalid_argument&) {
+        is_thrown = true;
+    }
+    TEST(is_thrown);
+}
+
+DEFINE_TEST_G(UpdateDistance_Updates_Implied_Reverse, TransportCatalogue_Tests) {
+    TransportCatalogue_Testing catalogue;
+    TransportCatalogue_Testing rebuilt;
+    for (TransportCatalogue_Testing* tc : {&catalogue, &rebuilt}) {
+        tc->AddStop("A", {55.0, 37.0});
+        tc->AddStop("B", {55.1, 37.1});
+        tc->AddStop("C", {55.2, 37.2});
+        tc->AddNeighborStopDistance("C"sv, "B"sv, 700);
+    }
+    catalogue.AddNeighborStopDistance("A"sv, "B"sv, 2000);
+    catalogue.AddNeighborStopDistance("B"sv, "C"sv, 500);
+    catalogue.AddBus("Bus1", {"A", "B", "C", "B", "A"});
+
+    catalogue.UpdateDistance("A", "B", 3000);
+    catalogue.UpdateDistance("B", "C", 900);
+
+    rebuilt.AddNeighborStopDistance("A"sv, "B"sv, 3000);
+    rebuilt.AddNeighborStopDistance("B"sv, "C"sv, 900);
+    rebuilt.AddBus("Bus1", {"A", "B", "C", "B", "A"});
+
+    const Stop* a = catalogue.FindStop("A");
+    const Stop* b = catalogue.FindStop("B");
+    const Stop* c = catalogue.FindStop("C");
+    TEST_EQ(b->neighbor_stops_dist_.at(a), 3000);
+    TEST_EQ(c->neighbor_stops_dist_.at(b), 700);
+    TEST_EQ(catalogue.GetRouteStatistics("Bus1").value().route_length_, 7600);
+    TEST_EQ(catalogue.GetRouteStatistics("Bus1").value().route_length_, 
+        rebuilt.GetRouteStatistics("Bus1").value().route_length_);
+
+    catalogue.UpdateDistance("B", "A", 2500);
+    catalogue.UpdateDistance("A", "B", 3500);
+    TEST_EQ(b->neighbor_stops_dist_.at(a), 2500);
+    TEST_EQ(a->neighbor_stops_dist_.at(b), 3500);
+}
+
+DEFINE_TEST_GF(Moved_Catalogue_Keeps_Stop_Coordinates, TransportCatalogue_Tests, ExceptionFixture) {
+    TransportCatalogue catalogue;
+    catalogue.AddStop("A", {55.1, 37.1});
+    catalogue.AddStop("B", {55.2, 37.2});
+    catalogue.AddBus("Bus1", {"A", "B"});
+    const Stop* b = catalogue.FindStop("B");
+
+    TransportCatalogue moved(std::move(catalogue));
+    moved.MoveStop("B", {55.3, 37.3});
+    TEST_EQ(moved.FindStop("B"), b);
+    TEST((b->GetCoordinates() == Coordinates(55.3, 37.3)));
+    TEST((moved.GetStopsCoordinates().Get(b->index_) == Coordinates(55.3, 37.3)));
+    TEST_EQ(moved.FindStop("A")->index_, 0u);
+    TEST_EQ(b->index_, 1u);
+}
+
 #endif
\ No newline at end of file
@@ -10,12 +10,19 @@
 #include "C:/dev/libs/time/time.h"
 
 #include <fstream>
+#include <random>
 
 using namespace std;
 
 void BenchmarkStringAndOstreamRender() {
     svg::Document doc;
-    vector<svg::Color> colors {svg::NoneColor, "red", svg::Rgb{0, 255, 0} , svg::Rgba{0, 0, 255, 0.5735678}};
+    auto color_table = make_shared<svg::ColorTable>();
+    vector<svg::ColorId> colors;
+    for (const svg::Color& color : {svg::NoneColor, svg::Color{"red"s}, svg::Color{svg::Rgb{0, 255, 0}},
+        svg::Color{svg::Rgba{0, 0, 255, 0.5735678}}}) {
+        colors.push_back(color_table->Intern(color));
+    }
+    doc.SetColorTable(color_table);
 
     for (int i = 0; i < 1000; i++){
         svg::Polyline line;
@@ -68,7 +75,7 @@ void BenchmarkBuildingSvgJson() {
     handler.ProvideInputRequests(transfport_catalogue);
     profiler.PrintResults<chrono::microseconds>("ProvideInputRequests: ");
 
-    vector<shared_ptr<Stat>> stats;
+    vector<StatAnswer> stats;
     MapRenderer::MapRenderer route_map;
     profiler.Restart();
     reader.ReadRenderSettingsJson(parsed_doc, route_map);
@@ -77,6 +84,14 @@ void BenchmarkBuildingSvgJson() {
         route_map.AddRoute(bus_ptr);
     }
     route_map.ReorderRouteColors();
+    profiler.Restart();
+    route_map.UpdateLayout();
+    profiler.PrintResults<chrono::microseconds>("UpdateLayout: ");
+
+    svg::Document map_doc;
+    profiler.Restart();
+    route_map.Draw(map_doc);
+    profiler.PrintResults<chrono::microseconds>("Draw map: ");
     
     stats = handler.GetStats(transfport_catalogue, route_map);
 
@@ -85,9 +100,69 @@ void BenchmarkBuildingSvgJson() {
     profiler.PrintResults<chrono::microseconds>("Build full json: ");
 }
 
+void BenchmarkDistanceModes() {
+    mt19937 generator(42);
+    uniform_real_distribution<double> latitude(55.5, 55.9);
+    uniform_real_distribution<double> longitude(37.3, 37.9);
+    vector<Geo::Coordinates> points;
+    for (int i = 0; i < 5000; i++) {
+        points.emplace_back(latitude(generator), longitude(generator));
+    }
+    vector<uint32_t> to(points.size());
+    for (uint32_t i = 0; i < to.size(); i++) {
+        to[i] = i;
+    }
+    vector<double> exact_distances(points.size());
+    vector<double> approximate_distances(points.size());
+
+    Profiler profiler;
+    double checksum = 0.0;
+    for (size_t from = 0; from < points.size(); from++) {
+        for (size_t i = 0; i < points.size(); i++) {
+            checksum += Geo::ComputeDistance(points[from], points[i]);
+        }
+    }
+    profiler.PrintResults<chrono::microseconds>("Exact acos distances: ");
+
+    Geo::DistanceTable exact(points);
+    profiler.Restart();
+    for (uint32_t from = 0; from < points.size(); from++) {
+        exact.ComputeDistances(from, to.data(), exact_distances.data(), to.size());
+        checksum += exact_distances.back();
+    }
+    profiler.PrintResults<chrono::microseconds>("Exact distance table: ");
+
+    Geo::DistanceTable approximate(points, Geo::DistanceMode::Approximate);
+    profiler.Restart();
+    for (uint32_t from = 0; from < points.size(); from++) {
+        approximate.ComputeDistances(from, to.data(), approximate_distances.data(), to.size());
+        checksum += approximate_distances.back();
+    }
+    profiler.PrintResults<chrono::microseconds>("Approximate distance table: ");
+
+    double max_error = 0.0;
+    double total_error = 0.0;
+    size_t pairs = 0;
+    for (uint32_t from = 0; from < points.size(); from++) {
+        exact.ComputeDistances(from, to.data(), exact_distances.data(), to.size());
+        approximate.ComputeDistances(from, to.data(), approximate_distances.data(), to.size());
+        for (size_t i = 0; i < to.size(); i++) {
+            if (exact_distances[i] > 0.0) {
+                const double error = abs(approximate_distances[i] - exact_distances[i]) / exact_distances[i];
+                max_error = max(max_error, error);
+                total_error += error;
+                ++pairs;
+            }
+        }
+    }
+    cout << "Approximate relative error: max "s << max_error << ", mean "s << total_error / pairs
+        << ", bound "s << approximate.GetRelativeErrorBound() << " ("s << checksum << ")"s << endl;
+}
+
 int main() {
     BenchmarkStringAndOstreamRender();
     BenchmarkBuildingSvgJson();
+    BenchmarkDistanceModes();
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,226 @@
+#include "main_tests.h"
+#ifdef DEBUG
+
+#include <fstream>
+#include <sstream>
+
+#include "../catalogue_store.h"
+#include "../json_reader.h"
+
+using namespace std;
+
+namespace {
+
+const string STORE_BASE_REQUESTS = R"({"base_requests": [
+    {"type": "Stop", "name": "Stop_1", "latitude": 55.611087, "longitude": 37.20829, "road_distances": {"Stop_2": 3900}},
+    {"type": "Stop", "name": "Stop_2", "latitude": 55.595884, "longitude": 37.209755, "road_distances": {"Stop_3": 2100}},
+    {"type": "Stop", "name": "Stop_3", "latitude": 55.632761, "longitude": 37.333324, "road_distances": {}},
+    {"type": "Bus", "name": "14", "stops": ["Stop_1", "Stop_2", "Stop_1"], "is_roundtrip": true},
+    {"type": "Bus", "name": "22", "stops": ["Stop_2", "Stop_3"], "is_roundtrip": false}
+], "render_settings": {"width": 600, "height": 400, "padding": 50, "stop_radius": 5, "line_width": 14,
+    "bus_label_font_size": 20, "bus_label_offset": [7, 15], "stop_label_font_size": 18, "stop_label_offset": [7, -3],
+    "underlayer_color": [255, 255, 255, 0.85], "underlayer_width": 3, "color_palette": ["green", [255, 160, 0], "red"]}})";
+
+unique_ptr<CatalogueSnapshot> MakeStoreSnapshot() {
+    istringstream base_input(STORE_BASE_REQUESTS);
+    return make_unique<CatalogueSnapshot>(json::Load(base_input));
+}
+
+string RenderStoreSnapshot(const CatalogueSnapshot& snapshot) {
+    ostringstream out;
+    svg::Document doc;
+    snapshot.route_map_->Draw(doc);
+    doc.Render(out);
+    return out.str();
+}
+
+}
+
+DEFINE_TEST_GF(Checkpoint_And_Replay, CatalogueStore_Tests, ExceptionFixture) {
+    const fs::path directory = fs::temp_directory_path() / "transport_catalogue_store_test";
+    fs::remove_all(directory);
+
+    unique_ptr<CatalogueSnapshot> expected = MakeStoreSnapshot();
+    {
+        CatalogueStore store(directory.string());
+        store.MakeCheckpoint(*expected);
+
+        CatalogueChange move_stop{ChangeType::MoveStop, "Stop_3"s};
+        move_stop.coords_ = {55.64, 37.34};
+        CatalogueChange update_distance{ChangeType::UpdateDistance, "Stop_2"s, "Stop_1"s};
+        update_distance.distance_ = 4100;
+
+        store.Apply(*expected, move_stop);
+        store.MakeCheckpoint(*expected);
+        store.Apply(*expected, update_distance);
+        store.Apply(*expected, {ChangeType::RemoveBus, "22"s});
+        TEST_EQ(store.GetLogTailSize(), (size_t)2);
+    }
+
+    CatalogueStore store(directory.string());
+    unique_ptr<CatalogueSnapshot> restored = store.Open();
+    TEST_EQ(store.GetLogTailSize(), (size_t)2);
+
+    TEST(restored->transport_c_.FindBus("22"s) == nullptr);
+    TEST_EQ(*restored->fragments_.FindBus("14"s), *expected->fragments_.FindBus("14"s));
+    TEST_EQ(*restored->fragments_.FindStop("Stop_3"s), *expected->fragments_.FindStop("Stop_3"s));
+    TEST_EQ(RenderStoreSnapshot(*restored), RenderStoreSnapshot(*expected));
+
+    fs::remove_all(directory);
+}
+
+DEFINE_TEST_GF(Rejected_Change_Is_Not_Logged, CatalogueStore_Tests, ExceptionFixture) {
+    const fs::path directory = fs::temp_directory_path() / "transport_catalogue_store_rejected_test";
+    fs::remove_all(directory);
+
+    unique_ptr<CatalogueSnapshot> snapshot = MakeStoreSnapshot();
+    CatalogueStore store(directory.string());
+    store.MakeCheckpoint(*snapshot);
+
+    CatalogueChange bad_route{ChangeType::UpdateBusRoute, "14"s};
+    bad_route.route_ = {"Stop_1"s, "Unknown"s};
+    for (const CatalogueChange& change : {bad_route, CatalogueChange{ChangeType::RemoveBus, "99"s}}) {
+        bool is_thrown = false;
+        try {
+            store.Apply(*snapshot, change);
+        } catch (const invalid_argument&) {
+            is_thrown = true;
+        }
+        TEST(is_thrown);
+    }
+    TEST_EQ(store.GetLogTailSize(), (size_t)0);
+    TEST_EQ(fs::file_size(directory / "catalogue.log"), (uintmax_t)0);
+    TEST_EQ(snapshot->transport_c_.FindBus("14"s)->route_.size(), (size_t)3);
+
+    store.Apply(*snapshot, {ChangeType::RemoveBus, "22"s});
+    const uintmax_t log_size = fs::file_size(directory / "catalogue.log");
+    ofstream(directory / "catalogue.log", ios::binary | ios::app) << "torn"s;
+
+    unique_ptr<CatalogueSnapshot> reloaded = store.Read();
+    TEST(reloaded->transport_c_.FindBus("22"s) == nullptr);
+    TEST_EQ(fs::file_size(directory / "catalogue.log"), log_size + 4);
+
+    fs::remove_all(directory);
+}
+
+DEFINE_TEST_GF(Rejected_Move_Keeps_Store_Reopenable, CatalogueStore_Tests, ExceptionFixture) {
+    const fs::path directory = fs::temp_directory_path() / "transport_catalogue_store_rejected_move_test";
+    fs::remove_all(directory);
+
+    string base_requests = STORE_BASE_REQUESTS;
+    base_requests.insert(1, R"("catalogue_settings": {"coordinates_encoding": "fixed_point"}, )"s);
+    istringstream base_input(base_requests);
+    CatalogueSnapshot snapshot(json::Load(base_input));
+    {
+        CatalogueStore store(directory.string());
+        store.MakeCheckpoint(snapshot);
+
+        CatalogueChange bad_move{ChangeType::MoveStop, "Stop_3"s};
+        bad_move.coords_ = {55.64, 200.0};
+        bool is_thrown = false;
+        try {
+            store.Apply(snapshot, bad_move);
+        } catch (const invalid_argument&) {
+            is_thrown = true;
+        }
+        TEST(is_thrown);
+        TEST_EQ(store.GetLogTailSize(), (size_t)0);
+
+        CatalogueChange move{ChangeType::MoveStop, "Stop_3"s};
+        move.coords_ = {55.64, 37.34};
+        store.Apply(snapshot, move);
+    }
+
+    CatalogueStore store(directory.string());
+    unique_ptr<CatalogueSnapshot> restored = store.Open();
+    TEST_EQ(store.GetLogTailSize(), (size_t)1);
+    TEST_EQ(restored->transport_c_.FindStop("Stop_3"s)->GetCoordinates().lng, 37.34);
+    TEST_EQ(*restored->fragments_.FindStop("Stop_3"s), *snapshot.fragments_.FindStop("Stop_3"s));
+
+    fs::remove_all(directory);
+}
+
+DEFINE_TEST_GF(Empty_Route_Is_Rejected, CatalogueStore_Tests, ExceptionFixture) {
+    const fs::path directory = fs::temp_directory_path() / "transport_catalogue_store_empty_route_test";
+    fs::remove_all(directory);
+
+    unique_ptr<CatalogueSnapshot> snapshot = MakeStoreSnapshot();
+    CatalogueStore store(directory.string());
+    store.MakeCheckpoint(*snapshot);
+
+    auto is_rejected = [](auto&& action) {
+        try {
+            action();
+        } catch (const invalid_argument&) {
+            return true;
+        }
+        return false;
+    };
+    istringstream change_input(R"({"type": "UpdateBusRoute", "name": "14", "stops": [], "is_roundtrip": false})");
+    const json::Document change_doc = json::Load(change_input);
+    TEST(is_rejected([&] { JsonReader().ReadChangeJson(change_doc.GetRoot()); }));
+    TEST(is_rejected([&] { store.Apply(*snapshot, {ChangeType::UpdateBusRoute, "14"s}); }));
+    TEST(is_rejected([&] { snapshot->transport_c_.UpdateBusRoute("14"s, {}); }));
+    TEST_EQ(fs::file_size(directory / "catalogue.log"), (uintmax_t)0);
+    TEST_EQ(snapshot->transport_c_.FindBus("14"s)->route_.size(), (size_t)3);
+    TEST_EQ(snapshot->transport_c_.GetRouteStatistics("14"s)->curvature_,
+        MakeStoreSnapshot()->transport_c_.GetRouteStatistics("14"s)->curvature_);
+
+    fs::remove_all(directory);
+}
+
+DEFINE_TEST_GF(Checkpoint_Keeps_Implied_Distances, CatalogueStore_Tests, ExceptionFixture) {
+    unique_ptr<CatalogueSnapshot> snapshot = MakeStoreSnapshot();
+    stringstream checkpoint_stream;
+    SaveCheckpoint(*snapshot, 0, checkpoint_stream);
+    Checkpoint checkpoint = LoadCheckpoint(checkpoint_stream);
+
+    for (CatalogueSnapshot* current : {snapshot.get(), checkpoint.snapshot_.get()}) {
+        current->UpdateDistance("Stop_1"s, "Stop_2"s, 5000);
+        const TransportCatalogue& transport_c = current->transport_c_;
+        const Stop* stop_1 = transport_c.FindStop("Stop_1"s);
+        const Stop* stop_2 = transport_c.FindStop("Stop_2"s);
+        TEST_EQ(stop_2->neighbor_stops_dist_.at(stop_1), (uint32_t)5000);
+    }
+    TEST_EQ(*checkpoint.snapshot_->fragments_.FindBus("14"s), *snapshot->fragments_.FindBus("14"s));
+}
+
+DEFINE_TEST_GF(Checkpoint_Keeps_Fixed_Point_Encoding, CatalogueStore_Tests, ExceptionFixture) {
+    string base_requests = STORE_BASE_REQUESTS;
+    base_requests.insert(1, R"("catalogue_settings": {"coordinates_encoding": "fixed_point"}, )"s);
+    istringstream base_input(base_requests);
+    CatalogueSnapshot snapshot(json::Load(base_input));
+    TEST(snapshot.transport_c_.GetStopsCoordinates().GetEncoding() == Geo::CoordinatesEncoding::FixedPoint);
+    TEST_EQ(snapshot.transport_c_.FindStop("Stop_1"s)->GetCoordinates().lat, 55.611087);
+
+    stringstream checkpoint_stream;
+    SaveCheckpoint(snapshot, 0, checkpoint_stream);
+    stringstream double_checkpoint_stream;
+    SaveCheckpoint(*MakeStoreSnapshot(), 0, double_checkpoint_stream);
+    TEST_EQ(double_checkpoint_stream.str().size() - checkpoint_stream.str().size(), (size_t)3 * 8);
+
+    Checkpoint checkpoint = LoadCheckpoint(checkpoint_stream);
+    const TransportCatalogue& restored = checkpoint.snapshot_->transport_c_;
+    TEST(restored.GetStopsCoordinates().GetEncoding() == Geo::CoordinatesEncoding::FixedPoint);
+    for (const Stop* stop : snapshot.transport_c_.GetAllStops()) {
+        const Geo::Coordinates expected = stop->GetCoordinates();
+        const Geo::Coordinates actual = restored.FindStop(stop->name_)->GetCoordinates();
+        TEST(expected.lat == actual.lat && expected.lng == actual.lng);
+    }
+    TEST_EQ(*checkpoint.snapshot_->fragments_.FindBus("14"s), *snapshot.fragments_.FindBus("14"s));
+}
+
+DEFINE_TEST_GF(Torn_Log_Tail, CatalogueStore_Tests, ExceptionFixture) {
+    ostringstream log_output;
+    WriteLoggedChange({1, {ChangeType::RemoveBus, "14"s}}, log_output);
+    WriteLoggedChange({2, {ChangeType::RemoveBus, "22"s}}, log_output);
+    const string log = log_output.str();
+
+    istringstream torn_log(log.substr(0, log.size() - 3));
+    vector<LoggedChange> changes = ReadLoggedChanges(torn_log);
+    TEST_EQ(changes.size(), (size_t)1);
+    TEST_EQ(changes[0].change_.name_, "14"s);
+    TEST_EQ(torn_log.tellg(), static_cast<streampos>(log.size() / 2));
+}
+
+#endif
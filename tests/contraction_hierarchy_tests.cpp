@@ -0,0 +1,94 @@
+#include "main_tests.h"
+#ifdef DEBUG
+
+#include <random>
+#include <sstream>
+
+#include "../contraction_hierarchy.h"
+
+using namespace std;
+using namespace graph;
+
+namespace {
+
+DirectedWeightedGraph<double> MakeRandomGraph(size_t vertex_count, size_t edge_count, unsigned seed) {
+    mt19937 generator(seed);
+    uniform_int_distribution<size_t> vertex(0, vertex_count - 1);
+    uniform_real_distribution<double> weight(0.5, 20.0);
+
+    DirectedWeightedGraph<double> result(vertex_count);
+    for (size_t i = 0; i < edge_count; ++i) {
+        result.AddEdge({vertex(generator), vertex(generator), weight(generator)});
+    }
+    return result;
+}
+
+bool IsValidPath(const DirectedWeightedGraph<double>& graph, VertexId from, VertexId to,
+    const Router<double>::RouteInfo& route) {
+    VertexId vertex = from;
+    double weight = 0.0;
+    for (EdgeId edge_id : route.edges_) {
+        const Edge<double>& edge = graph.GetEdge(edge_id);
+        if (edge.from_ != vertex) {
+            return false;
+        }
+        vertex = edge.to_;
+        weight += edge.weight_;
+    }
+    return vertex == to && Geo::IsEqualDouble(weight, route.weight_);
+}
+
+}
+
+DEFINE_TEST_GF(Hierarchy_Matches_Dijkstra, ContractionHierarchy_Tests, ExceptionFixture) {
+    DirectedWeightedGraph<double> graph = MakeRandomGraph(300, 1200, 7);
+    Router<double> router(graph);
+    ContractionHierarchy hierarchy(graph);
+
+    size_t mismatches = 0;
+    for (VertexId from = 0; from < graph.GetVertexCount(); from += 7) {
+        for (VertexId to = 0; to < graph.GetVertexCount(); to += 5) {
+            auto expected = router.BuildRoute(from, to);
+            auto actual = hierarchy.BuildRoute(from, to);
+            if (expected.has_value() != actual.has_value()) {
+                ++mismatches;
+                continue;
+            }
+            if (expected && (!Geo::IsEqualDouble(expected->weight_, actual->weight_)
+                || !IsValidPath(graph, from, to, *actual))) {
+                ++mismatches;
+            }
+        }
+    }
+    TEST_EQ(mismatches, (size_t)0);
+}
+
+DEFINE_TEST_GF(Hierarchy_Save_And_Load, ContractionHierarchy_Tests, ExceptionFixture) {
+    DirectedWeightedGraph<double> graph = MakeRandomGraph(100, 400, 11);
+    ContractionHierarchy hierarchy(graph);
+
+    stringstream stream;
+    hierarchy.Save(stream);
+    ContractionHierarchy loaded(graph, stream);
+    TEST_EQ(loaded.GetShortcutsCount(), hierarchy.GetShortcutsCount());
+
+    auto expected = hierarchy.BuildRoute(3, 42);
+    auto actual = loaded.BuildRoute(3, 42);
+    TEST_EQ(expected.has_value(), actual.has_value());
+    if (expected && actual) {
+        TEST(expected->edges_ == actual->edges_);
+    }
+
+    DirectedWeightedGraph<double> other_graph = MakeRandomGraph(100, 400, 12);
+    stream.clear();
+    stream.seekg(0);
+    bool is_thrown = false;
+    try {
+        ContractionHierarchy mismatched(other_graph, stream);
+    } catch (const runtime_error&) {
+        is_thrown = true;
+    }
+    TEST(is_thrown);
+}
+
+#endif
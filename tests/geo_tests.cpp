@@ -0,0 +1,237 @@
+#include "main_tests.h"
+#ifdef DEBUG
+
+#include <limits>
+#include <random>
+
+#include "../geo.h"
+
+using namespace std;
+using namespace Geo;
+
+namespace {
+
+vector<Coordinates> MakeRandomPoints(size_t count, unsigned seed, Coordinates min = {-80.0, -180.0},
+    Coordinates max = {80.0, 180.0}) {
+    mt19937 generator(seed);
+    uniform_real_distribution<double> latitude(min.lat, max.lat);
+    uniform_real_distribution<double> longitude(min.lng, max.lng);
+    vector<Coordinates> result;
+    for (size_t i = 0; i < count; ++i) {
+        result.emplace_back(latitude(generator), longitude(generator));
+    }
+    return result;
+}
+
+bool IsCloseDistance(double expected, double actual) {
+    return abs(expected - actual) <= max(0.5, expected * 1e-9);
+}
+
+}
+
+DEFINE_TEST_GF(Distance_Table_Matches_ComputeDistance, Geo_Tests, ExceptionFixture) {
+    vector<Coordinates> points = MakeRandomPoints(203, 17);
+    points.push_back(points.front());
+    DistanceTable table(points);
+    TEST_EQ(table.GetPointsCount(), points.size());
+
+    vector<uint32_t> from;
+    vector<uint32_t> to;
+    for (uint32_t i = 0; i < points.size(); ++i) {
+        from.push_back(i);
+        to.push_back(static_cast<uint32_t>((i * 7 + 3) % points.size()));
+    }
+    vector<double> pairwise(points.size());
+    vector<double> one_to_many(points.size());
+    table.ComputeDistances(from.data(), to.data(), pairwise.data(), points.size());
+    table.ComputeDistances(5, to.data(), one_to_many.data(), points.size());
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (!IsCloseDistance(ComputeDistance(points[from[i]], points[to[i]]), pairwise[i])
+            || !IsCloseDistance(ComputeDistance(points[5], points[to[i]]), one_to_many[i])
+            || pairwise[i] != table.ComputeDistance(from[i], to[i])) {
+            ++mismatches;
+        }
+    }
+    TEST_EQ(mismatches, (size_t)0);
+    TEST_EQ(table.ComputeDistance(0, static_cast<uint32_t>(points.size() - 1)), 0.0);
+
+    double path_length = 0.0;
+    for (size_t i = 1; i < points.size(); ++i) {
+        path_length += ComputeDistance(points[i - 1], points[i]);
+    }
+    TEST(abs(table.ComputePathLength() - path_length) < 1.0);
+    TEST_EQ(DistanceTable({points.front()}).ComputePathLength(), 0.0);
+}
+
+DEFINE_TEST_GF(Distance_Table_City_Batch_Matches_Single, Geo_Tests, ExceptionFixture) {
+    vector<Coordinates> points = MakeRandomPoints(257, 37, {55.5, 37.3}, {55.9, 37.9});
+    DistanceTable table(points);
+    vector<uint32_t> to(points.size());
+    for (uint32_t i = 0; i < to.size(); ++i) {
+        to[i] = i;
+    }
+    vector<double> distances(points.size());
+
+    size_t mismatches = 0;
+    for (uint32_t from = 0; from < points.size(); from += 3) {
+        table.ComputeDistances(from, to.data(), distances.data(), to.size());
+        for (uint32_t i = 0; i < to.size(); ++i) {
+            if (distances[i] != table.ComputeDistance(from, i)
+                || !IsCloseDistance(ComputeDistance(points[from], points[i]), distances[i])) {
+                ++mismatches;
+            }
+        }
+    }
+    TEST_EQ(mismatches, (size_t)0);
+}
+
+DEFINE_TEST_GF(Distance_Table_Updates_Match_Rebuilt, Geo_Tests, ExceptionFixture) {
+    vector<Coordinates> points = MakeRandomPoints(101, 29);
+    DistanceTable table;
+    for (Coordinates point : points) {
+        table.PushBack(point);
+    }
+    vector<Coordinates> moved = MakeRandomPoints(10, 31);
+    for (size_t i = 0; i < moved.size(); ++i) {
+        points[i * 10] = moved[i];
+        table.Set(i * 10, moved[i]);
+    }
+    const DistanceTable rebuilt(points);
+    TEST_EQ(table.GetPointsCount(), points.size());
+
+    size_t mismatches = 0;
+    for (uint32_t from = 0; from < points.size(); ++from) {
+        for (uint32_t to = 0; to < points.size(); to += 7) {
+            if (table.ComputeDistance(from, to) != rebuilt.ComputeDistance(from, to)) {
+                ++mismatches;
+            }
+        }
+    }
+    TEST_EQ(mismatches, (size_t)0);
+
+    bool is_thrown = false;
+    try {
+        DistanceTable(points, DistanceMode::Approximate).Set(0, points[1]);
+    } catch (const logic_error&) {
+        is_thrown = true;
+    }
+    TEST(is_thrown);
+}
+
+DEFINE_TEST_GF(Approximate_Distance_Within_Bound, Geo_Tests, ExceptionFixture) {
+    const vector<pair<Coordinates, Coordinates>> extents{
+        {{55.5, 37.3}, {55.9, 37.9}},
+        {{43.0, 131.8}, {43.3, 132.2}},
+        {{-34.2, 150.5}, {-33.5, 151.4}},
+        {{59.0, 29.5}, {61.0, 31.5}},
+        {{-1.0, 10.0}, {1.0, 12.0}}
+    };
+    for (const auto& [min, max] : extents) {
+        vector<Coordinates> points = MakeRandomPoints(300, 23, min, max);
+        DistanceTable approximate(points, DistanceMode::Approximate);
+        DistanceTable exact(points);
+        TEST(approximate.GetMode() == DistanceMode::Approximate);
+        TEST_EQ(exact.GetRelativeErrorBound(), 0.0);
+        TEST(approximate.GetRelativeErrorBound() > 0.0 && approximate.GetRelativeErrorBound() < 0.05);
+
+        vector<uint32_t> to(points.size());
+        vector<double> approximate_distances(points.size());
+        vector<double> exact_distances(points.size());
+        for (uint32_t i = 0; i < points.size(); ++i) {
+            to[i] = i;
+        }
+        size_t violations = 0;
+        for (uint32_t from = 0; from < points.size(); ++from) {
+            approximate.ComputeDistances(from, to.data(), approximate_distances.data(), to.size());
+            exact.ComputeDistances(from, to.data(), exact_distances.data(), to.size());
+            for (size_t i = 0; i < to.size(); ++i) {
+                if (abs(approximate_distances[i] - exact_distances[i])
+                    > exact_distances[i] * approximate.GetRelativeErrorBound() + 1e-6) {
+                    ++violations;
+                }
+            }
+        }
+        TEST_EQ(violations, (size_t)0);
+    }
+    TEST_EQ(DistanceTable({{55.7, 37.6}}, DistanceMode::Approximate).GetRelativeErrorBound(), 0.0);
+    TEST(DistanceTable({{55.5, 37.3}, {55.9, 37.9}}, DistanceMode::Approximate).GetRelativeErrorBound() < 0.01);
+}
+
+DEFINE_TEST_GF(Coordinates_Array_Encodings, Geo_Tests, ExceptionFixture) {
+    vector<Coordinates> points = MakeRandomPoints(500, 31);
+    for (Coordinates& point : points) {
+        point.lat = round(point.lat * 1e7) / 1e7;
+        point.lng = round(point.lng * 1e7) / 1e7;
+    }
+    CoordinatesArray doubles(points.begin(), points.end());
+    CoordinatesArray fixed(points.begin(), points.end(), CoordinatesEncoding::FixedPoint);
+    TEST(fixed.GetEncoding() == CoordinatesEncoding::FixedPoint);
+    TEST_EQ(fixed.GetSize(), points.size());
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < points.size(); ++i) {
+        const Coordinates decoded = fixed.Get(i);
+        if (decoded.lat != points[i].lat || decoded.lng != points[i].lng
+            || doubles.Get(i).lat != points[i].lat || doubles.Get(i).lng != points[i].lng) {
+            ++mismatches;
+        }
+    }
+    TEST_EQ(mismatches, (size_t)0);
+
+    fixed.Set(3, {-89.9999999, 179.9999999});
+    TEST_EQ(fixed.Get(3).lat, -89.9999999);
+    TEST_EQ(fixed.Get(3).lng, 179.9999999);
+    fixed.Set(3, points[3]);
+
+    const DistanceTable doubles_table(doubles);
+    const DistanceTable fixed_table(fixed);
+    TEST_EQ(doubles_table.ComputePathLength(), fixed_table.ComputePathLength());
+    const SphereProjector doubles_projector(doubles, 600.0, 400.0, 50.0);
+    const SphereProjector fixed_projector(fixed, 600.0, 400.0, 50.0);
+    const SphereProjector points_projector(points.begin(), points.end(), 600.0, 400.0, 50.0);
+    const svg::Point expected = points_projector.RescaleCoordinates(points[7]);
+    TEST_EQ(doubles_projector.RescaleCoordinates(points[7]).x, expected.x);
+    TEST_EQ(fixed_projector.RescaleCoordinates(points[7]).y, expected.y);
+
+    TEST(fixed.CanStore({-90.0, 180.0}));
+    TEST(!fixed.CanStore({0.0, 400.0}));
+    TEST(CoordinatesArray().CanStore({0.0, 400.0}));
+    bool is_thrown = false;
+    try {
+        fixed.PushBack({0.0, 400.0});
+    } catch (const out_of_range&) {
+        is_thrown = true;
+    }
+    TEST(is_thrown);
+}
+
+DEFINE_TEST_GF(Projector_Batch_Matches_Single, Geo_Tests, ExceptionFixture) {
+    for (size_t count : {1, 3, 9, 1001}) {
+        vector<Coordinates> points = MakeRandomPoints(count, static_cast<unsigned>(count), {55.5, 37.3}, {55.9, 37.9});
+        for (CoordinatesEncoding encoding : {CoordinatesEncoding::Double, CoordinatesEncoding::FixedPoint}) {
+            const CoordinatesArray coords(points.begin(), points.end(), encoding);
+            const SphereProjector projector(coords, 1200.0, 1200.0, 50.0);
+            vector<svg::Point> batch(5);
+            projector.RescaleCoordinates(coords, batch);
+            TEST_EQ(batch.size(), count);
+
+            size_t mismatches = 0;
+            double min_x = numeric_limits<double>::infinity();
+            double min_y = numeric_limits<double>::infinity();
+            for (size_t i = 0; i < count; ++i) {
+                const svg::Point single = projector.RescaleCoordinates(coords.Get(i));
+                if (abs(single.x - batch[i].x) > 1e-9 || abs(single.y - batch[i].y) > 1e-9) {
+                    ++mismatches;
+                }
+                min_x = min(min_x, batch[i].x);
+                min_y = min(min_y, batch[i].y);
+            }
+            TEST_EQ(mismatches, (size_t)0);
+            TEST(abs(min_x - 50.0) < 1e-6 && abs(min_y - 50.0) < 1e-6);
+        }
+    }
+}
+
+#endif
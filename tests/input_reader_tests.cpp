@@ -98,11 +98,11 @@ DEFINE_TEST_G(Standart_Test, InputRead_Testing) {
     reader.ApplyCommands(catalogue);
 
     TEST(*catalogue.FindStop("Tolstopaltsevo"s) == 
-    Stop("Tolstopaltsevo"s, Coordinates{55.611087, 37.208290}));
+    Stop("Tolstopaltsevo"s));
     TEST(*catalogue.FindStop("Rasskazovka"s) == 
-    Stop("Rasskazovka"s, Coordinates{55.632761, 37.333324}));
+    Stop("Rasskazovka"s));
     TEST(*catalogue.FindStop("Biryulyovo Passazhirskaya"s) == 
-    Stop("Biryulyovo Passazhirskaya"s, Coordinates{55.580999, 37.659164}));
+    Stop("Biryulyovo Passazhirskaya"s));
 
     RouteStatistics stat = catalogue.GetRouteStatistics("750"s);
 
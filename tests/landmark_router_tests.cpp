@@ -0,0 +1,115 @@
+#include "main_tests.h"
+#ifdef DEBUG
+
+#include <random>
+
+#include "../landmark_router.h"
+
+using namespace std;
+using namespace graph;
+
+namespace {
+
+DirectedWeightedGraph<double> MakeGridGraph(size_t side, unsigned seed) {
+    mt19937 generator(seed);
+    uniform_real_distribution<double> weight(1.0, 10.0);
+
+    DirectedWeightedGraph<double> result(side * side);
+    for (size_t row = 0; row < side; ++row) {
+        for (size_t column = 0; column < side; ++column) {
+            const VertexId vertex = row * side + column;
+            if (column + 1 < side) {
+                result.AddEdge({vertex, vertex + 1, weight(generator)});
+                result.AddEdge({vertex + 1, vertex, weight(generator)});
+            }
+            if (row + 1 < side) {
+                result.AddEdge({vertex, vertex + side, weight(generator)});
+                result.AddEdge({vertex + side, vertex, weight(generator)});
+            }
+        }
+    }
+    return result;
+}
+
+}
+
+DEFINE_TEST_GF(Landmarks_Match_Dijkstra, LandmarkRouter_Tests, ExceptionFixture) {
+    const size_t side = 30;
+    DirectedWeightedGraph<double> graph = MakeGridGraph(side, 5);
+    graph.AddEdge({0, side * side - 1, 1000.0});
+    Router<double> router(graph);
+    ThreadPool pool(4);
+    LandmarkRouter plain(graph, {}, pool);
+    LandmarkRouter landmarks(graph, {0, side - 1, side * (side - 1), side * side - 1}, pool);
+
+    size_t mismatches = 0;
+    size_t plain_settled = 0;
+    size_t landmarks_settled = 0;
+    for (VertexId from = 0; from < graph.GetVertexCount(); from += 37) {
+        for (VertexId to = 5; to < graph.GetVertexCount(); to += 53) {
+            auto expected = router.BuildRoute(from, to);
+            size_t settled = 0;
+            auto plain_route = plain.BuildRoute(from, to, &settled);
+            plain_settled += settled;
+            auto actual = landmarks.BuildRoute(from, to, &settled);
+            landmarks_settled += settled;
+
+            if (!expected || !actual || !plain_route
+                || !Geo::IsEqualDouble(expected->weight_, actual->weight_)
+                || !Geo::IsEqualDouble(expected->weight_, plain_route->weight_)) {
+                ++mismatches;
+                continue;
+            }
+            double weight = 0.0;
+            VertexId vertex = from;
+            for (EdgeId edge_id : actual->edges_) {
+                const Edge<double>& edge = graph.GetEdge(edge_id);
+                mismatches += edge.from_ != vertex;
+                vertex = edge.to_;
+                weight += edge.weight_;
+            }
+            mismatches += vertex != to || !Geo::IsEqualDouble(weight, actual->weight_);
+        }
+    }
+    TEST_EQ(mismatches, (size_t)0);
+    TEST(landmarks_settled * 2 < plain_settled);
+}
+
+DEFINE_TEST_GF(Landmarks_Parallel_Queries_Reuse_Scratch, LandmarkRouter_Tests, ExceptionFixture) {
+    const size_t side = 20;
+    DirectedWeightedGraph<double> graph = MakeGridGraph(side, 11);
+    Router<double> router(graph);
+    ThreadPool pool(4);
+    LandmarkRouter landmarks(graph, {0, side * side - 1}, pool);
+
+    const size_t queries_count = 400;
+    vector<double> weights(queries_count, -1.0);
+    pool.ParallelFor(queries_count, [&](size_t query) {
+        auto route = landmarks.BuildRoute((query * 7) % (side * side), (query * 13 + 5) % (side * side));
+        weights[query] = route ? route->weight_ : -1.0;
+    });
+
+    size_t mismatches = 0;
+    for (size_t query = 0; query < queries_count; ++query) {
+        auto expected = router.BuildRoute((query * 7) % (side * side), (query * 13 + 5) % (side * side));
+        mismatches += !expected || !Geo::IsEqualDouble(expected->weight_, weights[query]);
+    }
+    TEST_EQ(mismatches, (size_t)0);
+}
+
+DEFINE_TEST_GF(Landmarks_Prune_Unreachable, LandmarkRouter_Tests, ExceptionFixture) {
+    DirectedWeightedGraph<double> graph(4);
+    graph.AddEdge({0, 1, 1.0});
+    graph.AddEdge({1, 2, 1.0});
+    graph.AddEdge({3, 2, 1.0});
+    ThreadPool pool(2);
+    LandmarkRouter landmarks(graph, {0, 3}, pool);
+
+    size_t settled = 0;
+    TEST(!landmarks.BuildRoute(0, 3, &settled).has_value());
+    TEST_EQ(settled, (size_t)1);
+    auto route = landmarks.BuildRoute(0, 2);
+    TEST(route.has_value() && Geo::IsEqualDouble(route->weight_, 2.0));
+}
+
+#endif
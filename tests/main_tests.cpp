@@ -95,7 +95,7 @@ string ExecuteRequestStat(fs::path in, bool render = true, ostream& out_source =
     TransportCatalogue transfport_catalogue;
     handler.ProvideInputRequests(transfport_catalogue);
 
-    vector<shared_ptr<Stat>> stats;
+    vector<StatAnswer> stats;
     if (render) {
         map_renderer::MapRenderer route_map;
         reader.ReadRenderSettingsJson(parsed_doc, route_map);
@@ -118,7 +118,7 @@ string ExecuteRequestStat(fs::path in, bool render = true, ostream& out_source =
     return output.str();
 }
 
-json::Document BuildDocRequestStat(fs::path in, bool render = true) {
+json::Document BuildDocRequestStat(fs::path in, bool render = true, bool parallel = false) {
     ifstream input(in);
     json::Document parsed_doc = json::Load(input);
 
@@ -130,7 +130,8 @@ json::Document BuildDocRequestStat(fs::path in, bool render = true) {
     TransportCatalogue transfport_catalogue;
     handler.ProvideInputRequests(transfport_catalogue);
     
-    vector<shared_ptr<Stat>> stats;
+    ThreadPool pool(4);
+    vector<StatAnswer> stats;
     if (render) {
         map_renderer::MapRenderer route_map;
         reader.ReadRenderSettingsJson(parsed_doc, route_map);
@@ -139,10 +140,12 @@ json::Document BuildDocRequestStat(fs::path in, bool render = true) {
         }
         route_map.ReorderRouteColors();
         
-        stats = handler.GetStats(transfport_catalogue, route_map);
+        stats = parallel ? handler.GetStatsParallel(transfport_catalogue, pool, route_map) 
+                         : handler.GetStats(transfport_catalogue, route_map);
     }
     else {
-        stats = handler.GetStats(transfport_catalogue);
+        stats = parallel ? handler.GetStatsParallel(transfport_catalogue, pool) 
+                         : handler.GetStats(transfport_catalogue);
     }
 
     return reader.BuildStatJsonOutput(stats);
@@ -236,6 +239,59 @@ DEFINE_TEST_G(Json_Main, MainTests) {
     }
 }
 
+DEFINE_TEST_G(Json_Main_Parallel, MainTests) {
+    const vector<pair<fs::path, fs::path>> cases {
+        {IN_FILE_JSON_1, OUT_FILE_JSON_1}, {IN_FILE_JSON_2, OUT_FILE_JSON_2}, {IN_FILE_JSON_3, OUT_FILE_JSON_3},
+        {IN_FILE_JSON_4, OUT_FILE_JSON_4}, {IN_FILE_JSON_5, OUT_FILE_JSON_5}, {IN_FILE_JSON_6, OUT_FILE_JSON_6},
+    };
+    for (const auto& [in_file, out_file] : cases) {
+        json::Document doc_result = BuildDocRequestStat(TESTS_PATH / in_file, false, true);
+        ifstream input(TESTS_PATH / out_file);
+        json::Document doc_test = json::Load(input);
+        TEST(doc_result == doc_test);
+    }
+
+    {
+        json::Document result_doc = BuildDocRequestStat(TESTS_PATH / IN_FILE_MAP_3, true, true);
+        ifstream test_stream_in(TESTS_PATH / OUT_FILE_MAP_3);
+        json::Document test_doc = json::Load(test_stream_in);
+        TEST(result_doc == test_doc);
+    }
+}
+
+json::Document BuildDocRequestStatFragments(fs::path in) {
+    ifstream input(in);
+    json::Document parsed_doc = json::Load(input);
+
+    RequestHander handler;
+    JsonReader reader;
+    reader.ReadBaseJsonRequests(parsed_doc, handler);
+    reader.ReadStatJsonRequests(parsed_doc, handler);
+
+    TransportCatalogue transfport_catalogue;
+    handler.ProvideInputRequests(transfport_catalogue);
+
+    StatFragments fragments(transfport_catalogue);
+    handler.SetStatFragments(&fragments);
+
+    stringstream output;
+    reader.WriteStatJsonOutput(handler.GetStats(transfport_catalogue), output);
+    return json::Load(output);
+}
+
+DEFINE_TEST_G(Json_Main_Fragments, MainTests) {
+    const vector<pair<fs::path, fs::path>> cases {
+        {IN_FILE_JSON_1, OUT_FILE_JSON_1}, {IN_FILE_JSON_2, OUT_FILE_JSON_2}, {IN_FILE_JSON_3, OUT_FILE_JSON_3},
+        {IN_FILE_JSON_4, OUT_FILE_JSON_4}, {IN_FILE_JSON_5, OUT_FILE_JSON_5}, {IN_FILE_JSON_6, OUT_FILE_JSON_6},
+    };
+    for (const auto& [in_file, out_file] : cases) {
+        json::Document doc_result = BuildDocRequestStatFragments(TESTS_PATH / in_file);
+        ifstream input(TESTS_PATH / out_file);
+        json::Document doc_test = json::Load(input);
+        TEST(doc_result == doc_test);
+    }
+}
+
 DEFINE_TEST_G(TransportCatalogue_Render_Main, MainRenderTests) {    
     {
         string str_rec = BuildMapSvg(TESTS_PATH / IN_FILE_RENDER_2);
@@ -266,6 +322,73 @@ DEFINE_TEST_G(TransportCatalogue_Render_Main, MainRenderTests) {
     }
 }
 
+DEFINE_TEST_G(Renderer_Copy_Owns_Colors, MainRenderTests) {
+    TransportCatalogue transport_c;
+    transport_c.AddStop("A"sv, {55.6, 37.2});
+    transport_c.AddStop("B"sv, {55.7, 37.3});
+    transport_c.AddBus("1"sv, {"A"sv, "B"sv});
+
+    map_renderer::MapRenderer route_map;
+    route_map.SetMapSize({600.0, 400.0}).SetPadding(50.0).SetLineWidth(10.0).SetStopsRadius(5.0);
+    route_map.AddColorToPalette("red"s);
+    route_map.AddRoute(transport_c.FindBus("1"sv));
+    route_map.ReorderRouteColors();
+
+    map_renderer::MapRenderer route_map_copy = route_map;
+    route_map_copy.SetUnderLayerColor(svg::Rgb{0, 128, 0});
+
+    auto render = [](const map_renderer::MapRenderer& renderer) {
+        svg::Document doc;
+        renderer.Draw(doc);
+        ostringstream output;
+        doc.Render(output);
+        return output.str();
+    };
+    const string original = render(route_map);
+    const string copied = render(route_map_copy);
+    TEST(original.find("stroke=\"red\""s) != string::npos);
+    TEST(original.find("rgb(0,128,0)"s) == string::npos);
+    TEST(copied.find("rgb(0,128,0)"s) != string::npos);
+}
+
+DEFINE_TEST_G(Renderer_Layout_Follows_Moved_Stop, MainRenderTests) {
+    TransportCatalogue transport_c;
+    transport_c.AddStop("A"sv, {55.6, 37.2});
+    transport_c.AddStop("B"sv, {55.7, 37.3});
+    transport_c.AddStop("C"sv, {55.65, 37.4});
+    transport_c.AddBus("1"sv, {"A"sv, "B"sv, "C"sv});
+    transport_c.AddBus("2"sv, {"C"sv, "A"sv});
+
+    auto make_renderer = [&transport_c] {
+        map_renderer::MapRenderer route_map;
+        route_map.SetMapSize({600.0, 400.0}).SetPadding(50.0).SetLineWidth(10.0).SetStopsRadius(5.0);
+        route_map.AddColorToPalette("red"s);
+        for (const Bus* bus : transport_c.GetAllBuses()) {
+            route_map.AddRoute(bus);
+        }
+        route_map.ReorderRouteColors();
+        return route_map;
+    };
+    auto render = [](const map_renderer::MapRenderer& renderer) {
+        svg::Document doc;
+        renderer.Draw(doc);
+        ostringstream output;
+        doc.Render(output);
+        return output.str();
+    };
+
+    map_renderer::MapRenderer route_map = make_renderer();
+    const string stale_render = render(route_map);
+    route_map.UpdateLayout();
+    TEST(render(route_map) == stale_render);
+
+    transport_c.MoveStop("B"sv, {55.8, 37.35});
+    route_map.MoveStop(transport_c.FindStop("B"sv));
+    const string moved_render = render(route_map);
+    TEST(moved_render != stale_render);
+    TEST(moved_render == render(make_renderer()));
+}
+
 DEFINE_TEST_G(TransportCatalogue_Map_Main, Json_Map_Tests) {    
     {
         json::Document result_doc = BuildDocRequestStat(TESTS_PATH / IN_FILE_MAP_DEF);
@@ -0,0 +1,123 @@
+#include "main_tests.h"
+#if defined(DEBUG) && defined(__linux__)
+
+#include <sstream>
+#include <thread>
+
+#include "../catalogue_snapshot.h"
+#include "../query_server.h"
+#include "../query_client.h"
+
+using namespace std;
+
+namespace {
+
+const string BASE_REQUESTS = R"({"base_requests": [
+    {"type": "Stop", "name": "Stop_1", "latitude": 55.611087, "longitude": 37.20829, "road_distances": {"Stop_2": 3900}},
+    {"type": "Stop", "name": "Stop_2", "latitude": 55.595884, "longitude": 37.209755, "road_distances": {}},
+    {"type": "Stop", "name": "Stop_3", "latitude": 55.632761, "longitude": 37.333324, "road_distances": {}},
+    {"type": "Bus", "name": "14", "stops": ["Stop_1", "Stop_2", "Stop_1"], "is_roundtrip": true}
+]})";
+
+const string BASE_REQUESTS_RELOADED = R"({"base_requests": [
+    {"type": "Stop", "name": "Stop_1", "latitude": 55.611087, "longitude": 37.20829, "road_distances": {"Stop_3": 1200}},
+    {"type": "Stop", "name": "Stop_3", "latitude": 55.632761, "longitude": 37.333324, "road_distances": {}},
+    {"type": "Bus", "name": "22", "stops": ["Stop_1", "Stop_3"], "is_roundtrip": false}
+]})";
+
+}
+
+DEFINE_TEST_GF(Serve_Bus_And_Stop, QueryServer_Tests, ExceptionFixture) {
+    SnapshotHolder snapshots;
+    istringstream base_input(BASE_REQUESTS);
+    snapshots.Reload(base_input);
+    StatScheduler scheduler(2, 1);
+
+    const string socket_path = (fs::temp_directory_path() / "transport_catalogue_test.sock").string();
+    QueryServer server(snapshots, scheduler);
+    server.Listen(socket_path);
+    thread server_thread([&server] { server.Run(); });
+
+    {
+        QueryClient client(socket_path);
+        client.Send(R"({"id": 1, "type": "Bus", "name": "14"})");
+        client.Send(R"({"id": 2, "type": "Stop", "name": "Stop_3"})");
+        client.Send(R"({"id": 3, "type": "Stop", "name": "Unknown"})");
+
+        TEST(client.Receive().starts_with(R"({"request_id" : 1, "curvature" : )"));
+        TEST_EQ(client.Receive(), R"({"request_id" : 2, "buses" : []})"s);
+        TEST_EQ(client.Receive(), R"({"request_id" : 3, "error_message" : "not found"})"s);
+    }
+
+    QueryLoadReport report = RunQueryLoad(socket_path, {R"({"id": 1, "type": "Stop", "name": "Stop_1"})"}, 4, 10);
+    TEST_EQ(report.requests_, (size_t)10);
+    TEST_EQ(report.error_answers_, (size_t)0);
+
+    server.Stop();
+    server_thread.join();
+}
+
+DEFINE_TEST_GF(Pipelined_Requests_Over_In_Flight_Cap, QueryServer_Tests, ExceptionFixture) {
+    SnapshotHolder snapshots;
+    istringstream base_input(BASE_REQUESTS);
+    snapshots.Reload(base_input);
+    StatScheduler scheduler(2, 1);
+
+    const string socket_path = (fs::temp_directory_path() / "transport_catalogue_pipeline_test.sock").string();
+    QueryServer server(snapshots, scheduler);
+    server.Listen(socket_path);
+    thread server_thread([&server] { server.Run(); });
+
+    {
+        const int requests_count = 2000;
+        QueryClient client(socket_path);
+        for (int id = 1; id <= requests_count; ++id) {
+            client.Send(R"({"id": )"s + to_string(id) + R"(, "type": "Stop", "name": "Stop_3"})"s);
+        }
+        for (int id = 1; id <= requests_count; ++id) {
+            TEST_EQ(client.Receive(), R"({"request_id" : )"s + to_string(id) + R"(, "buses" : []})"s);
+        }
+    }
+
+    server.Stop();
+    server_thread.join();
+}
+
+DEFINE_TEST_GF(Parse_Request_Line_Once, QueryServer_Tests, ExceptionFixture) {
+    SnapshotHolder snapshots;
+    istringstream base_input(BASE_REQUESTS);
+    snapshots.Reload(base_input);
+    shared_ptr<const CatalogueSnapshot> snapshot = snapshots.Load();
+
+    JsonReader reader;
+    shared_ptr<const StatJsonLine> request = reader.ReadStatJsonLine(R"({"id": 7, "type": "Stop", "name": "Stop_3"})");
+    TEST(request->stat_.has_value());
+    TEST(request->stat_->type_ == RequestType::Stop);
+    TEST_EQ(request->stat_->name_, "Stop_3"sv);
+    TEST_EQ(reader.AnswerStatJson(*request, snapshot->handler_, snapshot->transport_c_, snapshot->route_map_), 
+        R"({"request_id" : 7, "buses" : []})"s);
+
+    shared_ptr<const StatJsonLine> broken = reader.ReadStatJsonLine(R"({"id": 8, "type": )");
+    TEST(!broken->stat_.has_value());
+    TEST(reader.AnswerStatJson(*broken, snapshot->handler_, snapshot->transport_c_, snapshot->route_map_)
+        .starts_with(R"({"error_message" : )"));
+}
+
+DEFINE_TEST_GF(Reload_Snapshot, QueryServer_Tests, ExceptionFixture) {
+    SnapshotHolder snapshots;
+    istringstream base_input(BASE_REQUESTS);
+    TEST_EQ(snapshots.Reload(base_input), (uint64_t)1);
+    shared_ptr<const CatalogueSnapshot> old_snapshot = snapshots.Load();
+
+    istringstream reloaded_input(BASE_REQUESTS_RELOADED);
+    TEST_EQ(snapshots.Reload(reloaded_input), (uint64_t)2);
+    shared_ptr<const CatalogueSnapshot> new_snapshot = snapshots.Load();
+
+    TEST_EQ(new_snapshot->version_, (uint64_t)2);
+    TEST(new_snapshot->transport_c_.FindBus("22"sv) != nullptr);
+    TEST(new_snapshot->transport_c_.FindBus("14"sv) == nullptr);
+    TEST(old_snapshot->transport_c_.FindBus("14"sv) != nullptr);
+    TEST_EQ(old_snapshot->transport_c_.FindBus("14"sv)->route_.size(), (size_t)3);
+}
+
+#endif
@@ -0,0 +1,77 @@
+#include "main_tests.h"
+#ifdef DEBUG
+
+#include <sstream>
+
+#include "../catalogue_snapshot.h"
+#include "../json_reader.h"
+#include "../route_cache.h"
+
+using namespace std;
+
+namespace {
+
+const string CACHE_BASE_REQUESTS = R"({"base_requests": [
+    {"type": "Stop", "name": "A", "latitude": 55.611087, "longitude": 37.20829, "road_distances": {"B": 2000}},
+    {"type": "Stop", "name": "B", "latitude": 55.595884, "longitude": 37.209755, "road_distances": {"C": 4000}},
+    {"type": "Stop", "name": "C", "latitude": 55.632761, "longitude": 37.333324, "road_distances": {}},
+    {"type": "Bus", "name": "1", "stops": ["A", "B", "C"], "is_roundtrip": false}
+], "routing_settings": {"bus_wait_time": 6, "bus_velocity": 40}})";
+
+}
+
+DEFINE_TEST_GF(Lru_Eviction_And_Versions, RouteCache_Tests, ExceptionFixture) {
+    RouteCache cache(2, 1);
+    cache.Insert("A"sv, "B"sv, 1, RouteInfo{1.0, {}});
+    cache.Insert("A"sv, "C"sv, 1, nullopt);
+    TEST(cache.Find("A"sv, "B"sv, 1).has_value());
+
+    cache.Insert("B"sv, "C"sv, 1, RouteInfo{3.0, {}});
+    TEST(!cache.Find("A"sv, "C"sv, 1).has_value());
+    optional<CachedRoute> cached = cache.Find("A"sv, "B"sv, 1);
+    TEST(cached.has_value() && cached->has_value());
+    TEST(Geo::IsEqualDouble((*cached)->total_time_, 1.0));
+
+    TEST(!cache.Find("A"sv, "B"sv, 2).has_value());
+    cache.Insert("A"sv, "B"sv, 1, RouteInfo{1.0, {}});
+    TEST(!cache.Find("A"sv, "B"sv, 1).has_value());
+    TEST_EQ(cache.GetStatistics().size_, (size_t)0);
+
+    RouteCacheStatistics statistics = cache.GetStatistics();
+    TEST_EQ(statistics.hits_, (uint64_t)2);
+    TEST_EQ(statistics.misses_, (uint64_t)3);
+}
+
+DEFINE_TEST_GF(Cached_Route_Answers, RouteCache_Tests, ExceptionFixture) {
+    RouteCache cache(16);
+    SnapshotHolder snapshots;
+    snapshots.SetRouteCache(&cache);
+    istringstream base_input(CACHE_BASE_REQUESTS);
+    snapshots.Reload(base_input);
+
+    shared_ptr<const CatalogueSnapshot> snapshot = snapshots.Load();
+    JsonReader reader;
+    auto answer = [&](const string& line) {
+        return reader.AnswerStatJsonLine(line, snapshot->handler_, snapshot->transport_c_, snapshot->route_map_);
+    };
+
+    const string expected = R"({"request_id" : 1, "items" : [{"stop_name" : "A", "time" : 6, "type" : "Wait"}, )"
+        R"({"bus" : "1", "span_count" : 2, "time" : 9, "type" : "Bus"}], "total_time" : 15})"s;
+    TEST_EQ(answer(R"({"id": 1, "type": "Route", "from": "A", "to": "C"})"), expected);
+    TEST_EQ(answer(R"({"id": 1, "type": "Route", "from": "A", "to": "C"})"), expected);
+    TEST_EQ(answer(R"({"id": 2, "type": "Route", "from": "A", "to": "Z"})"),
+        R"({"request_id" : 2, "error_message" : "not found"})"s);
+    TEST_EQ(answer(R"({"id": 2, "type": "Route", "from": "A", "to": "Z"})"),
+        R"({"request_id" : 2, "error_message" : "not found"})"s);
+    TEST_EQ(cache.GetStatistics().hits_, (uint64_t)2);
+    TEST_EQ(cache.GetStatistics().misses_, (uint64_t)2);
+
+    istringstream reloaded_input(CACHE_BASE_REQUESTS);
+    snapshots.Reload(reloaded_input);
+    snapshot = snapshots.Load();
+    TEST_EQ(answer(R"({"id": 1, "type": "Route", "from": "A", "to": "C"})"), expected);
+    TEST_EQ(cache.GetStatistics().misses_, (uint64_t)3);
+    TEST_EQ(cache.GetStatistics().size_, (size_t)1);
+}
+
+#endif
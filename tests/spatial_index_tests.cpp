@@ -0,0 +1,350 @@
+#include "main_tests.h"
+#ifdef DEBUG
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+
+#include "../catalogue_snapshot.h"
+#include "../json_reader.h"
+#include "../spatial_index.h"
+
+using namespace std;
+
+namespace {
+
+const string SPATIAL_BASE_REQUESTS = R"({"base_requests": [
+    {"type": "Stop", "name": "A", "latitude": 55.611087, "longitude": 37.20829, "road_distances": {}},
+    {"type": "Stop", "name": "B", "latitude": 55.595884, "longitude": 37.209755, "road_distances": {}},
+    {"type": "Stop", "name": "C", "latitude": 55.632761, "longitude": 37.333324, "road_distances": {}},
+    {"type": "Stop", "name": "D", "latitude": 55.574371, "longitude": 37.6517, "road_distances": {}},
+    {"type": "Bus", "name": "1", "stops": ["A", "B"], "is_roundtrip": false},
+    {"type": "Bus", "name": "2", "stops": ["A", "C"], "is_roundtrip": false}
+]})";
+
+vector<Stop> MakeRandomStops(size_t count, unsigned seed, double span, Geo::CoordinatesArray& coords) {
+    mt19937 generator(seed);
+    uniform_real_distribution<double> latitude(55.5, 55.5 + span);
+    uniform_real_distribution<double> longitude(37.3, 37.3 + span * 1.5);
+
+    vector<Stop> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        coords.PushBack({latitude(generator), longitude(generator)});
+        result.emplace_back("Stop "s + to_string(i), &coords, static_cast<uint32_t>(i));
+    }
+    return result;
+}
+
+double ComputeSampledSegmentDistance(Geo::Coordinates point, Geo::Coordinates from, Geo::Coordinates to) {
+    const size_t samples = 200;
+    double result = numeric_limits<double>::infinity();
+    for (size_t i = 0; i <= samples; ++i) {
+        const double ratio = static_cast<double>(i) / samples;
+        const Geo::Coordinates sample(from.lat + (to.lat - from.lat) * ratio, from.lng + (to.lng - from.lng) * ratio);
+        result = min(result, Geo::ComputeDistance(point, sample));
+    }
+    return result;
+}
+
+}
+
+DEFINE_TEST_GF(Index_Matches_Brute_Force, SpatialIndex_Tests, ExceptionFixture) {
+    Geo::CoordinatesArray coords;
+    vector<Stop> stops = MakeRandomStops(2000, 5, 0.4, coords);
+    vector<const Stop*> stop_ptrs;
+    for (const Stop& stop : stops) {
+        stop_ptrs.push_back(&stop);
+    }
+    StopsIndex index(stop_ptrs);
+    TEST_EQ(index.GetStopsCount(), stops.size());
+
+    mt19937 generator(9);
+    uniform_real_distribution<double> latitude(55.5, 55.9);
+    uniform_real_distribution<double> longitude(37.3, 37.9);
+    size_t mismatches = 0;
+    for (size_t query = 0; query < 50; ++query) {
+        const Geo::Coordinates point(latitude(generator), longitude(generator));
+        vector<double> distances;
+        for (const Stop& stop : stops) {
+            distances.push_back(Geo::ComputeDistance(point, stop.GetCoordinates()));
+        }
+        sort(distances.begin(), distances.end());
+
+        vector<NearbyStop> nearest = index.FindNearest(point, 10);
+        if (nearest.size() != 10) {
+            ++mismatches;
+            continue;
+        }
+        for (size_t i = 0; i < nearest.size(); ++i) {
+            if (abs(nearest[i].distance_ - distances[i]) > 0.5) {
+                ++mismatches;
+            }
+        }
+
+        const double radius = 1500.0;
+        const size_t expected = upper_bound(distances.begin(), distances.end(), radius) - distances.begin();
+        vector<NearbyStop> within = index.FindWithinRadius(point, radius);
+        if (within.size() != expected || !is_sorted(within.begin(), within.end(),
+            [](const NearbyStop& lhs, const NearbyStop& rhs) { return lhs.distance_ < rhs.distance_; })) {
+            ++mismatches;
+        }
+    }
+    TEST_EQ(mismatches, (size_t)0);
+    TEST_EQ(index.FindNearest({55.7, 37.6}, 5000).size(), stops.size());
+    TEST(index.FindNearest({55.7, 37.6}, 0).empty());
+}
+
+DEFINE_TEST_GF(Moved_Stops_Match_Rebuilt_Index, SpatialIndex_Tests, ExceptionFixture) {
+    Geo::CoordinatesArray coords;
+    vector<Stop> stops = MakeRandomStops(2000, 6, 0.4, coords);
+    vector<const Stop*> stop_ptrs;
+    for (const Stop& stop : stops) {
+        stop_ptrs.push_back(&stop);
+    }
+    StopsIndex index(stop_ptrs);
+
+    mt19937 generator(10);
+    uniform_int_distribution<size_t> stop_index(0, 99);
+    uniform_real_distribution<double> latitude(55.5, 55.9);
+    uniform_real_distribution<double> longitude(37.3, 37.9);
+    auto same_answer = [](const vector<NearbyStop>& lhs, const vector<NearbyStop>& rhs) {
+        return equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), [](const NearbyStop& l, const NearbyStop& r) {
+            return l.stop_ == r.stop_ && l.distance_ == r.distance_;
+        });
+    };
+    size_t mismatches = 0;
+    for (size_t move = 1; move <= 300; ++move) {
+        Stop& moved = stops[stop_index(generator) * 20];
+        coords.Set(moved.index_, {latitude(generator), longitude(generator)});
+        index.MoveStop(&moved);
+        if (move % 30 != 0) {
+            continue;
+        }
+        const StopsIndex rebuilt(stop_ptrs);
+        for (size_t query = 0; query < 20; ++query) {
+            const Geo::Coordinates point(latitude(generator), longitude(generator));
+            if (!same_answer(index.FindNearest(point, 10), rebuilt.FindNearest(point, 10))
+                || !same_answer(index.FindWithinRadius(point, 3000.0), rebuilt.FindWithinRadius(point, 3000.0))) {
+                ++mismatches;
+            }
+        }
+    }
+    TEST_EQ(mismatches, (size_t)0);
+    TEST_EQ(index.GetStopsCount(), stops.size());
+    TEST_EQ(index.FindNearest({55.7, 37.6}, 5000).size(), stops.size());
+}
+
+DEFINE_TEST_GF(Segments_Match_Brute_Force, SpatialIndex_Tests, ExceptionFixture) {
+    Geo::CoordinatesArray coords;
+    vector<Stop> stops = MakeRandomStops(500, 3, 0.05, coords);
+    mt19937 generator(4);
+    uniform_int_distribution<size_t> stop_index(0, stops.size() - 1);
+    vector<Bus> buses(300);
+    vector<const Bus*> bus_ptrs;
+    for (size_t i = 0; i < buses.size(); ++i) {
+        buses[i].name_ = to_string(i);
+        for (size_t j = 0; j < 1 + i % 6; ++j) {
+            buses[i].route_.push_back(&stops[stop_index(generator)]);
+        }
+        bus_ptrs.push_back(&buses[i]);
+    }
+    SegmentsIndex index(bus_ptrs);
+
+    uniform_real_distribution<double> latitude(55.5, 55.55);
+    uniform_real_distribution<double> longitude(37.3, 37.375);
+    const double radius = 500.0;
+    size_t mismatches = 0;
+    for (size_t query = 0; query < 20; ++query) {
+        const Geo::Coordinates point(latitude(generator), longitude(generator));
+        unordered_map<const Bus*, double> found;
+        for (const NearbyBus& nearby : index.FindBusesWithinRadius(point, radius)) {
+            found[nearby.bus_] = nearby.distance_;
+        }
+
+        for (const Bus& bus : buses) {
+            double expected = numeric_limits<double>::infinity();
+            for (size_t i = 0; i < bus.route_.size(); ++i) {
+                const Stop* to = bus.route_[min(i + 1, bus.route_.size() - 1)];
+                expected = min(expected, ComputeSampledSegmentDistance(point, bus.route_[i]->GetCoordinates(), to->GetCoordinates()));
+            }
+            auto it = found.find(&bus);
+            if (expected < radius - 10.0 && (it == found.end() || abs(it->second - expected) > 10.0)) {
+                ++mismatches;
+            }
+            if (expected > radius + 10.0 && it != found.end()) {
+                ++mismatches;
+            }
+        }
+    }
+    TEST_EQ(mismatches, (size_t)0);
+    TEST(SegmentsIndex().FindBusesWithinRadius({55.7, 37.6}, 1000.0).empty());
+}
+
+DEFINE_TEST_GF(Updated_Buses_Match_Rebuilt_Segments, SpatialIndex_Tests, ExceptionFixture) {
+    Geo::CoordinatesArray coords;
+    vector<Stop> stops = MakeRandomStops(500, 7, 0.05, coords);
+    mt19937 generator(11);
+    uniform_int_distribution<size_t> stop_index(0, stops.size() - 1);
+    vector<Bus> buses(300);
+    for (size_t i = 0; i < buses.size(); ++i) {
+        buses[i].name_ = to_string(i);
+        for (size_t j = 0; j < 1 + i % 6; ++j) {
+            buses[i].route_.push_back(&stops[stop_index(generator)]);
+        }
+    }
+    vector<bool> removed(buses.size(), false);
+    auto live_buses = [&] {
+        vector<const Bus*> result;
+        for (size_t i = 0; i < buses.size(); ++i) {
+            if (!removed[i]) {
+                result.push_back(&buses[i]);
+            }
+        }
+        return result;
+    };
+    SegmentsIndex index(live_buses());
+
+    uniform_int_distribution<size_t> bus_index(0, buses.size() - 1);
+    uniform_real_distribution<double> latitude(55.5, 55.55);
+    uniform_real_distribution<double> longitude(37.3, 37.375);
+    size_t mismatches = 0;
+    for (size_t change = 1; change <= 240; ++change) {
+        const size_t bus = bus_index(generator);
+        if (change % 3 == 0 && !removed[bus]) {
+            removed[bus] = true;
+            index.RemoveBus(&buses[bus]);
+        } else if (change % 3 == 1 && !removed[bus]) {
+            buses[bus].route_ = {&stops[stop_index(generator)], &stops[stop_index(generator)], &stops[stop_index(generator)]};
+            index.UpdateBus(&buses[bus]);
+        } else if (!removed[bus]) {
+            coords.Set(buses[bus].route_.front()->index_, {latitude(generator), longitude(generator)});
+            for (size_t i = 0; i < buses.size(); ++i) {
+                if (!removed[i] && count(buses[i].route_.begin(), buses[i].route_.end(), buses[bus].route_.front())) {
+                    index.UpdateBus(&buses[i]);
+                }
+            }
+        }
+        if (change % 40 != 0) {
+            continue;
+        }
+        const SegmentsIndex rebuilt(live_buses());
+        TEST_EQ(index.GetSegmentsCount(), rebuilt.GetSegmentsCount());
+        for (size_t query = 0; query < 10; ++query) {
+            const Geo::Coordinates point(latitude(generator), longitude(generator));
+            vector<NearbyBus> actual = index.FindBusesWithinRadius(point, 500.0);
+            vector<NearbyBus> expected = rebuilt.FindBusesWithinRadius(point, 500.0);
+            if (!equal(actual.begin(), actual.end(), expected.begin(), expected.end(),
+                [](const NearbyBus& lhs, const NearbyBus& rhs) { return lhs.bus_ == rhs.bus_ && lhs.distance_ == rhs.distance_; })) {
+                ++mismatches;
+            }
+        }
+    }
+    TEST_EQ(mismatches, (size_t)0);
+}
+
+DEFINE_TEST_GF(Hilbert_Reorder_Keeps_Catalogue, SpatialIndex_Tests, ExceptionFixture) {
+    Geo::CoordinatesArray coords;
+    vector<Stop> stops = MakeRandomStops(300, 6, 0.4, coords);
+    TransportCatalogue transport_c(Geo::CoordinatesEncoding::FixedPoint);
+    for (const Stop& stop : stops) {
+        transport_c.AddStop(stop.name_, stop.GetCoordinates());
+    }
+    vector<vector<string_view>> routes(20);
+    for (size_t i = 0; i < stops.size(); ++i) {
+        routes[i % routes.size()].push_back(stops[i].name_);
+        if (i + 1 < stops.size()) {
+            transport_c.AddNeighborStopDistance(stops[i].name_, stops[i + 1].name_, static_cast<uint32_t>(100 + i));
+        }
+    }
+    for (size_t i = 0; i < routes.size(); ++i) {
+        transport_c.AddBus(to_string(i), routes[i]);
+    }
+
+    auto measure_order = [&transport_c]() {
+        vector<const Stop*> all_stops = transport_c.GetAllStops();
+        double result = 0.0;
+        for (size_t i = 1; i < all_stops.size(); ++i) {
+            result += Geo::ComputeDistance(all_stops[i - 1]->GetCoordinates(), all_stops[i]->GetCoordinates());
+        }
+        return result;
+    };
+    vector<RouteStatistics> statistics;
+    for (size_t i = 0; i < routes.size(); ++i) {
+        statistics.push_back(*transport_c.GetRouteStatistics(to_string(i)));
+    }
+    const double insertion_order = measure_order();
+
+    transport_c.ReorderStopsAlongHilbertCurve();
+    TEST(measure_order() < insertion_order / 4.0);
+    TEST_EQ(transport_c.GetAllStops().size(), stops.size());
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < routes.size(); ++i) {
+        const RouteStatistics reordered = *transport_c.GetRouteStatistics(to_string(i));
+        if (!Geo::IsEqualDouble(reordered.route_length_, statistics[i].route_length_)
+            || !Geo::IsEqualDouble(reordered.curvature_, statistics[i].curvature_)) {
+            ++mismatches;
+        }
+        const Bus* bus = transport_c.FindBus(to_string(i));
+        for (size_t j = 0; j < routes[i].size(); ++j) {
+            if (bus->route_[j] != transport_c.FindStop(routes[i][j])) {
+                ++mismatches;
+            }
+        }
+    }
+    for (size_t i = 0; i + 1 < stops.size(); ++i) {
+        const Stop* from = transport_c.FindStop(stops[i].name_);
+        const Stop* to = transport_c.FindStop(stops[i + 1].name_);
+        if (from->neighbor_stops_dist_.at(to) != 100 + i || transport_c.FindBuses(stops[i].name_)->size() != 1) {
+            ++mismatches;
+        }
+    }
+    const Geo::CoordinatesArray& catalogue_coords = transport_c.GetStopsCoordinates();
+    transport_c.MoveStop(stops[42].name_, {55.70000004, 37.6});
+    vector<const Stop*> all_stops = transport_c.GetAllStops();
+    TEST_EQ(catalogue_coords.GetSize(), all_stops.size());
+    for (size_t i = 0; i < all_stops.size(); ++i) {
+        if (all_stops[i]->index_ != i || catalogue_coords.Get(i) != all_stops[i]->GetCoordinates()) {
+            ++mismatches;
+        }
+    }
+    TEST_EQ(mismatches, (size_t)0);
+    TEST_EQ(transport_c.FindStop(stops[42].name_)->GetCoordinates().lat, 55.7);
+}
+
+DEFINE_TEST_GF(Nearby_Stops_Json_Answers, SpatialIndex_Tests, ExceptionFixture) {
+    istringstream base_input(SPATIAL_BASE_REQUESTS);
+    CatalogueSnapshot snapshot(json::Load(base_input));
+    JsonReader reader;
+    auto answer = [&](const string& line) {
+        return reader.AnswerStatJsonLine(line, snapshot.handler_, snapshot.transport_c_, snapshot.route_map_);
+    };
+
+    const string nearest = answer(R"({"id": 1, "type": "NearestStops", "latitude": 55.6, "longitude": 37.21, "count": 2})");
+    TEST(nearest.find("\"stop_name\" : \"B\"}, {\"distance\""s) != string::npos);
+    TEST(nearest.find("\"stop_name\" : \"A\"}]"s) != string::npos);
+
+    TEST_EQ(answer(R"({"id": 2, "type": "StopsInRadius", "latitude": 55.574371, "longitude": 37.6517, "radius": 100})"),
+        R"({"request_id" : 2, "stops" : [{"distance" : 0, "stop_name" : "D"}]})"s);
+    TEST_EQ(answer(R"({"id": 3, "type": "StopsInRadius", "latitude": 0, "longitude": 0, "radius": 1000})"),
+        R"({"request_id" : 3, "stops" : []})"s);
+
+    const string buses = answer(R"({"id": 5, "type": "BusesNearby", "latitude": 55.6035, "longitude": 37.209, "radius": 500})");
+    TEST(buses.find("[{\"bus\" : \"1\", \"distance\" : "s) != string::npos);
+    TEST(buses.find("\"2\""s) == string::npos);
+    TEST_EQ(answer(R"({"id": 6, "type": "BusesNearby", "latitude": 55.632761, "longitude": 37.333324, "radius": 1})"),
+        R"({"request_id" : 6, "buses" : [{"bus" : "2", "distance" : 0}]})"s);
+
+    snapshot.RemoveBus("2"s);
+    TEST_EQ(answer(R"({"id": 7, "type": "BusesNearby", "latitude": 55.632761, "longitude": 37.333324, "radius": 1})"),
+        R"({"request_id" : 7, "buses" : []})"s);
+
+    snapshot.MoveStop("D"sv, {0.0, 0.0});
+    TEST_EQ(answer(R"({"id": 4, "type": "StopsInRadius", "latitude": 0, "longitude": 0, "radius": 1000})"),
+        R"({"request_id" : 4, "stops" : [{"distance" : 0, "stop_name" : "D"}]})"s);
+}
+
+#endif
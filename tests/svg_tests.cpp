@@ -12,17 +12,19 @@ using namespace std;
 namespace svg {
 
 DEFINE_TEST_G( WriteToOstream, SVG_Document_Testring) {
+    auto colors = make_shared<ColorTable>();
     Circle circle_1;
     Circle circle_2;
     Circle circle_3;
-    circle_1.SetRadius(50).SetCenter({100.54, 100.5}).SetStrokeWidth(10).SetFillColor("yellow");
-    circle_2.SetRadius(75).SetCenter({100.52, 150.52}).SetStrokeWidth(15).SetFillColor("black");
-    circle_3.SetRadius(100).SetCenter({100.554, 250.5}).SetStrokeWidth(20).SetFillColor("red");
+    circle_1.SetRadius(50).SetCenter({100.54, 100.5}).SetStrokeWidth(10).SetFillColor(colors->Intern("yellow"s));
+    circle_2.SetRadius(75).SetCenter({100.52, 150.52}).SetStrokeWidth(15).SetFillColor(colors->Intern("black"s));
+    circle_3.SetRadius(100).SetCenter({100.554, 250.5}).SetStrokeWidth(20).SetFillColor(colors->Intern("red"s));
     Text text;
-    text.SetData("Testing"s).SetFillColor(Rgb{0, 0, 255}).SetPosition({30, 20}).SetStrokeWidth(5).
+    text.SetData("Testing"s).SetFillColor(colors->Intern(Rgb{0, 0, 255})).SetPosition({30, 20}).SetStrokeWidth(5).
     SetFontSize(20).SetFontWeight("bold"s).SetFontFamily("Verdana"s);
 
     Document doc;
+    doc.SetColorTable(colors);
     doc.AddObject(circle_1);
     doc.AddObject(circle_2);
     doc.AddObject(circle_3);
@@ -39,6 +41,35 @@ DEFINE_TEST_G( WriteToOstream, SVG_Document_Testring) {
     }
 }
 
+DEFINE_TEST_G(ColorTable_Intern, SVG_Document_Testring) {
+    auto colors = make_shared<ColorTable>();
+    ColorId red = colors->Intern("red"s);
+    ColorId rgba = colors->Intern(Rgba{0, 0, 255, 0.5});
+    ColorId unset = colors->Intern(monostate{});
+
+    TEST(colors->Intern("red"s) == red);
+    TEST(colors->Intern(Rgba{0, 0, 255, 0.5}) == rgba);
+    TEST(unset == UnsetColor);
+    TEST_EQ(colors->Size(), (size_t)3);
+    TEST_EQ(colors->Get(rgba), "rgba(0,0,255,0.5)"s);
+
+    Circle circle;
+    circle.SetCenter({10, 20}).SetRadius(5).SetFillColor(rgba).SetStrokeColor(unset);
+
+    Document doc;
+    doc.SetColorTable(colors);
+    doc.AddObject(circle);
+    ostringstream with_ids;
+    doc.Render(with_ids);
+    TEST(with_ids.str().find("<circle cx=\"10\" cy=\"20\" r=\"5\" fill=\"rgba(0,0,255,0.5)\"/>"s) != string::npos);
+
+    Document doc_plain;
+    doc_plain.AddObject(Circle().SetCenter({10, 20}).SetRadius(5));
+    ostringstream without_colors;
+    doc_plain.Render(without_colors);
+    TEST(without_colors.str().find("<circle cx=\"10\" cy=\"20\" r=\"5\"/>"s) != string::npos);
+}
+
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "main_tests.h"
+#ifdef DEBUG
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#include "../thread_pool.h"
+
+using namespace std;
+
+DEFINE_TEST_GF(Parallel_For_Batches_Are_Independent, ThreadPool_Tests, ExceptionFixture) {
+    ThreadPool pool(4);
+    atomic<bool> slow_started = false;
+    atomic<bool> release_slow = false;
+    atomic<size_t> slow_done = 0;
+    thread slow_caller([&] {
+        pool.ParallelFor(2, [&](size_t) {
+            slow_started = true;
+            while (!release_slow) {
+                this_thread::yield();
+            }
+            ++slow_done;
+        });
+    });
+    while (!slow_started) {
+        this_thread::yield();
+    }
+
+    bool is_thrown = false;
+    try {
+        pool.ParallelFor(100, [](size_t i) {
+            if (i == 42) {
+                throw runtime_error("failed chunk"s);
+            }
+        });
+    } catch (const runtime_error&) {
+        is_thrown = true;
+    }
+    TEST(is_thrown);
+    TEST_EQ(slow_done.load(), (size_t)0);
+
+    atomic<size_t> sum = 0;
+    pool.ParallelFor(1000, [&](size_t i) { sum += i; });
+    TEST_EQ(sum.load(), (size_t)499500);
+
+    release_slow = true;
+    slow_caller.join();
+    TEST_EQ(slow_done.load(), (size_t)2);
+}
+
+DEFINE_TEST_GF(Nested_Parallel_For_Completes, ThreadPool_Tests, ExceptionFixture) {
+    ThreadPool pool(2);
+    atomic<size_t> visited = 0;
+    pool.ParallelFor(8, [&](size_t) {
+        pool.ParallelFor(16, [&](size_t) { ++visited; });
+    });
+    TEST_EQ(visited.load(), (size_t)128);
+}
+
+DEFINE_TEST_GF(Shared_Pool_Is_Reused, ThreadPool_Tests, ExceptionFixture) {
+    ThreadPool& pool = ThreadPool::GetShared();
+    TEST(&pool == &ThreadPool::GetShared());
+    atomic<size_t> visited = 0;
+    pool.ParallelFor(64, [&](size_t) { ++visited; });
+    TEST_EQ(visited.load(), (size_t)64);
+}
+
+#endif
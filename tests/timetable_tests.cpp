@@ -0,0 +1,84 @@
+#include "main_tests.h"
+#ifdef DEBUG
+
+#include <sstream>
+
+#include "../catalogue_snapshot.h"
+#include "../catalogue_store.h"
+#include "../json_reader.h"
+
+using namespace std;
+
+namespace {
+
+const string SCHEDULED_BASE_REQUESTS = R"({"base_requests": [
+    {"type": "Stop", "name": "A", "latitude": 55.611087, "longitude": 37.20829, "road_distances": {"B": 2000}},
+    {"type": "Stop", "name": "B", "latitude": 55.595884, "longitude": 37.209755, "road_distances": {"C": 4000}},
+    {"type": "Stop", "name": "C", "latitude": 55.632761, "longitude": 37.333324, "road_distances": {"D": 1000}},
+    {"type": "Stop", "name": "D", "latitude": 55.574371, "longitude": 37.6517, "road_distances": {}},
+    {"type": "Bus", "name": "1", "stops": ["A", "B", "C"], "is_roundtrip": false},
+    {"type": "Bus", "name": "3", "stops": ["C", "D", "C"], "is_roundtrip": true}
+], "routing_settings": {"bus_wait_time": 6, "bus_velocity": 40},
+"schedules": [
+    {"bus": "1", "departures": [500, 480]},
+    {"bus": "3", "first_departure": 485, "last_departure": 505, "interval": 10}
+]})";
+
+unique_ptr<CatalogueSnapshot> MakeScheduledSnapshot() {
+    istringstream base_input(SCHEDULED_BASE_REQUESTS);
+    return make_unique<CatalogueSnapshot>(json::Load(base_input));
+}
+
+}
+
+DEFINE_TEST_GF(Earliest_Arrival_With_Transfer, Timetable_Tests, ExceptionFixture) {
+    unique_ptr<CatalogueSnapshot> snapshot = MakeScheduledSnapshot();
+    TEST_EQ(snapshot->timetable_->GetTripsCount(), (size_t)5);
+
+    optional<JourneyInfo> journey = snapshot->timetable_->BuildJourney("A"sv, "D"sv, 470.0);
+    TEST(journey.has_value());
+    TEST(Geo::IsEqualDouble(journey->arrival_time_, 496.5));
+    TEST(Geo::IsEqualDouble(journey->total_time_, 26.5));
+    TEST_EQ(journey->items_.size(), (size_t)4);
+
+    const RouteWait& first_wait = get<RouteWait>(journey->items_[0]);
+    TEST_EQ(first_wait.stop_->name_, "A"s);
+    TEST(Geo::IsEqualDouble(first_wait.time_, 10.0));
+    const RouteRide& first_ride = get<RouteRide>(journey->items_[1]);
+    TEST_EQ(first_ride.bus_->name_, "1"s);
+    TEST_EQ(first_ride.span_count_, 2);
+    TEST(Geo::IsEqualDouble(first_ride.time_, 9.0));
+    const RouteWait& transfer = get<RouteWait>(journey->items_[2]);
+    TEST_EQ(transfer.stop_->name_, "C"s);
+    TEST(Geo::IsEqualDouble(transfer.time_, 6.0));
+    TEST_EQ(get<RouteRide>(journey->items_[3]).bus_->name_, "3"s);
+
+    TEST(!snapshot->timetable_->BuildJourney("A"sv, "D"sv, 481.0).has_value());
+    TEST(!snapshot->timetable_->BuildJourney("A"sv, "Z"sv, 470.0).has_value());
+
+    optional<JourneyInfo> stay = snapshot->timetable_->BuildJourney("B"sv, "B"sv, 600.0);
+    TEST(stay.has_value() && stay->items_.empty() && Geo::IsEqualDouble(stay->arrival_time_, 600.0));
+}
+
+DEFINE_TEST_GF(Journey_Json_Answers, Timetable_Tests, ExceptionFixture) {
+    unique_ptr<CatalogueSnapshot> snapshot = MakeScheduledSnapshot();
+    JsonReader reader;
+    auto answer = [&](const CatalogueSnapshot& current, const string& line) {
+        return reader.AnswerStatJsonLine(line, current.handler_, current.transport_c_, current.route_map_);
+    };
+
+    const string expected = R"({"request_id" : 1, "arrival_time" : 489, "items" : [{"stop_name" : "B", "time" : 0, "type" : "Wait"}, )"
+        R"({"bus" : "1", "span_count" : 1, "time" : 6, "type" : "Bus"}], "total_time" : 6})"s;
+    TEST_EQ(answer(*snapshot, R"({"id": 1, "type": "Journey", "from": "B", "to": "C", "departure_time": 483})"), expected);
+    TEST_EQ(answer(*snapshot, R"({"id": 2, "type": "Journey", "from": "A", "to": "D", "departure_time": 481})"),
+        R"({"request_id" : 2, "error_message" : "not found"})"s);
+
+    stringstream checkpoint_stream;
+    SaveCheckpoint(*snapshot, 0, checkpoint_stream);
+    Checkpoint checkpoint = LoadCheckpoint(checkpoint_stream);
+    TEST(checkpoint.snapshot_->timetable_.has_value());
+    TEST_EQ(answer(*checkpoint.snapshot_, R"({"id": 1, "type": "Journey", "from": "B", "to": "C", "departure_time": 483})"),
+        expected);
+}
+
+#endif
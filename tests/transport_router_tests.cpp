@@ -0,0 +1,270 @@
+#include "main_tests.h"
+#ifdef DEBUG
+
+#include <sstream>
+
+#include "../catalogue_snapshot.h"
+#include "../json_reader.h"
+
+using namespace std;
+
+namespace {
+
+const string ROUTING_BASE_REQUESTS = R"({"base_requests": [
+    {"type": "Stop", "name": "A", "latitude": 55.611087, "longitude": 37.20829, "road_distances": {"B": 2000}},
+    {"type": "Stop", "name": "B", "latitude": 55.595884, "longitude": 37.209755, "road_distances": {"C": 4000}},
+    {"type": "Stop", "name": "C", "latitude": 55.632761, "longitude": 37.333324, "road_distances": {"D": 1000}},
+    {"type": "Stop", "name": "D", "latitude": 55.574371, "longitude": 37.6517, "road_distances": {}},
+    {"type": "Stop", "name": "E", "latitude": 55.581065, "longitude": 37.64839, "road_distances": {}},
+    {"type": "Bus", "name": "1", "stops": ["A", "B", "C"], "is_roundtrip": false},
+    {"type": "Bus", "name": "3", "stops": ["C", "D", "C"], "is_roundtrip": true}
+], "routing_settings": {"bus_wait_time": 6, "bus_velocity": 40},
+"render_settings": {"width": 600, "height": 400, "padding": 50, "stop_radius": 5, "line_width": 14,
+    "bus_label_font_size": 20, "bus_label_offset": [7, 15], "stop_label_font_size": 18, "stop_label_offset": [7, -3],
+    "underlayer_color": [255, 255, 255, 0.85], "underlayer_width": 3, "color_palette": ["green"]}})";
+
+unique_ptr<CatalogueSnapshot> MakeRoutingSnapshot() {
+    istringstream base_input(ROUTING_BASE_REQUESTS);
+    return make_unique<CatalogueSnapshot>(json::Load(base_input));
+}
+
+}
+
+DEFINE_TEST_GF(Route_With_Transfer, TransportRouter_Tests, ExceptionFixture) {
+    unique_ptr<CatalogueSnapshot> snapshot = MakeRoutingSnapshot();
+
+    optional<RouteInfo> route = snapshot->router_->BuildRoute("A"sv, "D"sv);
+    TEST(route.has_value());
+    TEST(Geo::IsEqualDouble(route->total_time_, 22.5));
+    TEST_EQ(route->items_.size(), (size_t)4);
+
+    const RouteWait& first_wait = get<RouteWait>(route->items_[0]);
+    TEST_EQ(first_wait.stop_->name_, "A"s);
+    TEST(Geo::IsEqualDouble(first_wait.time_, 6.0));
+
+    const RouteRide& first_ride = get<RouteRide>(route->items_[1]);
+    TEST_EQ(first_ride.bus_->name_, "1"s);
+    TEST_EQ(first_ride.span_count_, 2);
+    TEST(Geo::IsEqualDouble(first_ride.time_, 9.0));
+
+    TEST_EQ(get<RouteWait>(route->items_[2]).stop_->name_, "C"s);
+    TEST_EQ(get<RouteRide>(route->items_[3]).bus_->name_, "3"s);
+}
+
+DEFINE_TEST_GF(Route_Json_Answers, TransportRouter_Tests, ExceptionFixture) {
+    unique_ptr<CatalogueSnapshot> snapshot = MakeRoutingSnapshot();
+    JsonReader reader;
+    auto answer = [&](const string& line) {
+        return reader.AnswerStatJsonLine(line, snapshot->handler_, snapshot->transport_c_, snapshot->route_map_);
+    };
+
+    TEST_EQ(answer(R"({"id": 1, "type": "Route", "from": "B", "to": "C"})"),
+        R"({"request_id" : 1, "items" : [{"stop_name" : "B", "time" : 6, "type" : "Wait"}, )"
+        R"({"bus" : "1", "span_count" : 1, "time" : 6, "type" : "Bus"}], "total_time" : 12})"s);
+    TEST_EQ(answer(R"({"id": 2, "type": "Route", "from": "A", "to": "A"})"),
+        R"({"request_id" : 2, "items" : [], "total_time" : 0})"s);
+    TEST_EQ(answer(R"({"id": 3, "type": "Route", "from": "A", "to": "E"})"),
+        R"({"request_id" : 3, "error_message" : "not found"})"s);
+
+    snapshot->RemoveBus("3"s);
+    snapshot->Refresh();
+    TEST_EQ(answer(R"({"id": 4, "type": "Route", "from": "A", "to": "D"})"),
+        R"({"request_id" : 4, "error_message" : "not found"})"s);
+}
+
+DEFINE_TEST_GF(Router_Is_Rebuilt_Once_After_Edits, TransportRouter_Tests, ExceptionFixture) {
+    unique_ptr<CatalogueSnapshot> snapshot = MakeRoutingSnapshot();
+    snapshot->router_->BuildHierarchy();
+
+    snapshot->UpdateDistance("A"sv, "B"sv, 1000);
+    snapshot->UpdateBusRoute("3"s, {"C"sv, "D"sv, "E"sv}, false);
+    snapshot->MoveStop("E"sv, {55.58, 37.65});
+    TEST(!snapshot->router_.has_value());
+
+    snapshot->Refresh();
+    TEST(snapshot->router_.has_value());
+    TEST(snapshot->router_->HasHierarchy());
+
+    unique_ptr<CatalogueSnapshot> expected = MakeRoutingSnapshot();
+    expected->transport_c_.UpdateDistance("A"sv, "B"sv, 1000);
+    expected->transport_c_.UpdateBusRoute("3"s, {"C"sv, "D"sv, "E"sv}, false);
+    const TransportRouter rebuilt(expected->transport_c_, snapshot->router_->GetSettings());
+    for (const Stop* from : snapshot->transport_c_.GetAllStops()) {
+        for (const Stop* to : snapshot->transport_c_.GetAllStops()) {
+            auto actual = snapshot->router_->BuildRoute(from->name_, to->name_);
+            auto reference = rebuilt.BuildRoute(from->name_, to->name_);
+            TEST_EQ(actual.has_value(), reference.has_value());
+            if (actual && reference) {
+                TEST(Geo::IsEqualDouble(actual->total_time_, reference->total_time_));
+            }
+        }
+    }
+}
+
+DEFINE_TEST_GF(Landmark_Routes_Match_Dijkstra, TransportRouter_Tests, ExceptionFixture) {
+    unique_ptr<CatalogueSnapshot> snapshot = MakeRoutingSnapshot();
+    string landmarks_base = ROUTING_BASE_REQUESTS;
+    landmarks_base.replace(landmarks_base.find("\"bus_velocity\": 40"s), 18, "\"bus_velocity\": 40, \"landmarks_count\": 2"s);
+    istringstream base_input(landmarks_base);
+    CatalogueSnapshot landmarks_snapshot(json::Load(base_input));
+    TEST(landmarks_snapshot.router_->HasLandmarks());
+    landmarks_base.replace(landmarks_base.find("\"landmarks_count\": 2"s), 20,
+        "\"landmarks_count\": 2, \"distance_mode\": \"approximate\""s);
+    istringstream approximate_input(landmarks_base);
+    CatalogueSnapshot approximate_snapshot(json::Load(approximate_input));
+    TEST(approximate_snapshot.router_->GetSettings().distance_mode_ == Geo::DistanceMode::Approximate);
+
+    for (const Stop* from : snapshot->transport_c_.GetAllStops()) {
+        for (const Stop* to : snapshot->transport_c_.GetAllStops()) {
+            auto expected = snapshot->router_->BuildRoute(from->name_, to->name_);
+            for (const CatalogueSnapshot* landmarks : {&landmarks_snapshot, &approximate_snapshot}) {
+                auto actual = landmarks->router_->BuildRoute(from->name_, to->name_);
+                TEST_EQ(expected.has_value(), actual.has_value());
+                if (expected && actual) {
+                    TEST(Geo::IsEqualDouble(expected->total_time_, actual->total_time_));
+                }
+            }
+        }
+    }
+
+    landmarks_base.replace(landmarks_base.find("approximate"s), 11, "planar"s);
+    istringstream invalid_input(landmarks_base);
+    bool is_thrown = false;
+    try {
+        CatalogueSnapshot invalid_snapshot(json::Load(invalid_input));
+    } catch (const invalid_argument&) {
+        is_thrown = true;
+    }
+    TEST(is_thrown);
+}
+
+DEFINE_TEST_GF(Isochrone_Answers, TransportRouter_Tests, ExceptionFixture) {
+    unique_ptr<CatalogueSnapshot> snapshot = MakeRoutingSnapshot();
+    JsonReader reader;
+    auto answer = [&](const string& line) {
+        return reader.AnswerStatJsonLine(line, snapshot->handler_, snapshot->transport_c_, snapshot->route_map_);
+    };
+
+    TEST_EQ(answer(R"({"id": 1, "type": "Isochrone", "from": "A", "max_time": 15})"),
+        R"({"request_id" : 1, "stops" : [{"stop_name" : "A", "time" : 0}, )"
+        R"({"stop_name" : "B", "time" : 9}, {"stop_name" : "C", "time" : 15}]})"s);
+    TEST_EQ(answer(R"({"id": 2, "type": "Isochrone", "from": "E", "max_time": 60})"),
+        R"({"request_id" : 2, "stops" : [{"stop_name" : "E", "time" : 0}]})"s);
+    TEST_EQ(answer(R"({"id": 3, "type": "Isochrone", "from": "Z", "max_time": 60})"),
+        R"({"request_id" : 3, "error_message" : "not found"})"s);
+
+    const string rendered = answer(R"({"id": 4, "type": "Isochrone", "from": "A", "max_time": 10, "render": true})");
+    TEST(rendered.find("\"map\" : "s) != string::npos);
+    TEST(rendered.find(">B</text>"s) != string::npos);
+    TEST(rendered.find(">C</text>"s) == string::npos);
+}
+
+DEFINE_TEST_GF(Travel_Matrix, TransportRouter_Tests, ExceptionFixture) {
+    unique_ptr<CatalogueSnapshot> snapshot = MakeRoutingSnapshot();
+    ThreadPool pool(2);
+
+    TravelMatrix matrix = snapshot->router_->BuildMatrix({"A"sv, "B"sv}, {"C"sv, "D"sv, "E"sv, "A"sv}, pool);
+    TEST_EQ(matrix.GetRowsCount(), (size_t)2);
+    TEST(Geo::IsEqualDouble(matrix.GetTime(0, 0), 15.0));
+    TEST(Geo::IsEqualDouble(matrix.GetDistance(0, 0), 6000.0));
+    TEST(Geo::IsEqualDouble(matrix.GetTime(0, 1), 22.5));
+    TEST(Geo::IsEqualDouble(matrix.GetDistance(0, 1), 7000.0));
+    TEST(!matrix.HasRoute(0, 2));
+    TEST(Geo::IsEqualDouble(matrix.GetTime(0, 3), 0.0));
+    TEST(Geo::IsEqualDouble(matrix.GetTime(1, 1), 19.5));
+    TEST(Geo::IsEqualDouble(matrix.GetDistance(1, 1), 5000.0));
+    TEST(Geo::IsEqualDouble(matrix.GetTime(1, 3), 9.0));
+    TEST(Geo::IsEqualDouble(matrix.GetDistance(1, 3), 2000.0));
+
+    bool is_thrown = false;
+    try {
+        snapshot->router_->BuildMatrix({"A"sv}, {"Z"sv}, pool);
+    } catch (const invalid_argument&) {
+        is_thrown = true;
+    }
+    TEST(is_thrown);
+}
+
+DEFINE_TEST_GF(Duplicate_Stats_Share_First_Answer, TransportRouter_Tests, ExceptionFixture) {
+    unique_ptr<CatalogueSnapshot> snapshot = MakeRoutingSnapshot();
+    istringstream stat_input(R"({"stat_requests": [
+        {"id": 1, "type": "Bus", "name": "1"},
+        {"id": 2, "type": "Stop", "name": "C"},
+        {"id": 3, "type": "Route", "from": "A", "to": "D"},
+        {"id": 4, "type": "Bus", "name": "1"},
+        {"id": 5, "type": "Stop", "name": "C"},
+        {"id": 6, "type": "Route", "from": "A", "to": "D"},
+        {"id": 7, "type": "Isochrone", "from": "A", "max_time": 15},
+        {"id": 8, "type": "Isochrone", "from": "A", "max_time": 5},
+        {"id": 9, "type": "Isochrone", "from": "A", "max_time": 15},
+        {"id": 10, "type": "StopsInRadius", "latitude": 55.6, "longitude": 37.2, "radius": 100},
+        {"id": 11, "type": "StopsInRadius", "latitude": 55.6, "longitude": 37.2, "radius": 2000},
+        {"id": 12, "type": "Route", "from": "D", "to": "A"}
+    ]})");
+    const json::Document stat_doc = json::Load(stat_input);
+    JsonReader reader;
+    reader.ReadStatJsonRequests(stat_doc, snapshot->handler_);
+
+    const vector<size_t> expected_origins{0, 1, 2, 0, 1, 2, 6, 7, 6, 9, 10, 11};
+    ThreadPool pool(2);
+    StatScheduler scheduler(1, 1);
+    TEST(scheduler.IsHeavy(RequestType::Route));
+    TEST(scheduler.IsHeavy(RequestType::Journey));
+    TEST(!scheduler.IsHeavy(RequestType::Bus));
+    TEST(!scheduler.IsHeavy(RequestType::Stop));
+    for (const vector<StatAnswer>& stats : {snapshot->handler_.GetStats(snapshot->transport_c_, snapshot->route_map_),
+        snapshot->handler_.GetStatsParallel(snapshot->transport_c_, pool, snapshot->route_map_),
+        snapshot->handler_.GetStatsParallel(snapshot->transport_c_, scheduler, snapshot->route_map_)}) {
+        TEST_EQ(stats.size(), expected_origins.size());
+        size_t mismatches = 0;
+        for (size_t i = 0; i < stats.size(); ++i) {
+            const StatDuplicate* duplicate = get_if<StatDuplicate>(&stats[i]);
+            if (expected_origins[i] == i ? duplicate != nullptr
+                : duplicate == nullptr || duplicate->origin_ != expected_origins[i] || duplicate->id_ != static_cast<int>(i + 1)) {
+                ++mismatches;
+            }
+        }
+        TEST_EQ(mismatches, (size_t)0);
+
+        const json::Document output = reader.BuildStatJsonOutput(stats);
+        const json::Array& answers = output.GetRoot().AsArray();
+        json::Dict duplicate_route = answers[5].AsMap();
+        TEST_EQ(duplicate_route.at("request_id"s).AsInt(), 6);
+        duplicate_route["request_id"s] = 3;
+        TEST(json::Node(duplicate_route) == answers[2]);
+        TEST(answers[7].AsMap().at("stops"s) != answers[6].AsMap().at("stops"s));
+    }
+}
+
+DEFINE_TEST_GF(Json_Lines_Answered_In_Order, TransportRouter_Tests, ExceptionFixture) {
+    unique_ptr<CatalogueSnapshot> snapshot = MakeRoutingSnapshot();
+    istringstream requests(
+        R"({"id": 1, "type": "Bus", "name": "1"})" "\n"
+        "\n"
+        R"({"id": 2, "type": "Stop", "name": "X"})" "\n"
+        R"({"id": 3, "type": "Route", "from": "B")" "\n"
+        R"({"id": 4, "type": "Route", "from": "B", "to": "C"})" "\n"
+        "   \n"
+        R"({"id": 5, "type": "Stop", "name": "C"})");
+    ostringstream out;
+    JsonReader reader;
+    reader.AnswerStatJsonLines(requests, out, snapshot->handler_, snapshot->transport_c_, snapshot->route_map_);
+
+    vector<string> answers;
+    istringstream out_lines(out.str());
+    string line;
+    while (getline(out_lines, line)) {
+        answers.push_back(line);
+    }
+    TEST_EQ(answers.size(), (size_t)7);
+    TEST(answers[0].find("{\"request_id\" : 1, \"curvature\""s) == 0);
+    TEST(answers[1].find("{\"error_message\" : "s) == 0);
+    TEST_EQ(answers[2], R"({"request_id" : 2, "error_message" : "not found"})"s);
+    TEST(answers[3].find("{\"error_message\" : "s) == 0);
+    TEST_EQ(answers[4], R"({"request_id" : 4, "items" : [{"stop_name" : "B", "time" : 6, "type" : "Wait"}, )"
+        R"({"bus" : "1", "span_count" : 1, "time" : 6, "type" : "Bus"}], "total_time" : 12})"s);
+    TEST(answers[5].find("{\"error_message\" : "s) == 0);
+    TEST_EQ(answers[6], R"({"request_id" : 5, "buses" : ["1", "3"]})"s);
+}
+
+#endif
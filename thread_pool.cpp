@@ -0,0 +1,158 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+using namespace std;
+
+ThreadPool::ThreadPool(size_t threads_count) {
+    threads_count = max<size_t>(threads_count, 1);
+    queues_.reserve(threads_count);
+    for (size_t i = 0; i < threads_count; ++i) {
+        queues_.push_back(make_unique<WorkQueue>());
+    }
+    workers_.reserve(threads_count);
+    for (size_t i = 0; i < threads_count; ++i) {
+        workers_.emplace_back([this, i] { WorkerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard lock(state_mutex_);
+        stop_ = true;
+    }
+    task_cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::GetShared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::Submit(function<void()> task) {
+    WorkQueue& queue = *queues_[next_queue_.fetch_add(1, memory_order_relaxed) % queues_.size()];
+    unfinished_.fetch_add(1);
+    {
+        lock_guard lock(queue.mutex_);
+        queue.tasks_.push_back(move(task));
+    }
+    queued_.fetch_add(1);
+    if (sleeping_.load() > 0) {
+        lock_guard lock(state_mutex_);
+        task_cv_.notify_one();
+    }
+}
+
+void ThreadPool::Wait() {
+    unique_lock lock(state_mutex_);
+    done_cv_.wait(lock, [this] { return unfinished_.load() == 0; });
+    if (error_) {
+        exception_ptr error = error_;
+        error_ = nullptr;
+        rethrow_exception(error);
+    }
+}
+
+ThreadPool::Batch::Batch(size_t chunks_count)
+    : chunks_count_(chunks_count) {
+}
+
+void ThreadPool::Batch::Run(const function<void(size_t)>& run_chunk) {
+    while (true) {
+        size_t chunk = 0;
+        {
+            lock_guard lock(mutex_);
+            if (next_chunk_ == chunks_count_) {
+                return;
+            }
+            chunk = next_chunk_++;
+        }
+
+        exception_ptr error;
+        try {
+            run_chunk(chunk);
+        } catch (...) {
+            error = current_exception();
+        }
+
+        lock_guard lock(mutex_);
+        if (error) {
+            if (!error_) {
+                error_ = error;
+            }
+            finished_ += chunks_count_ - next_chunk_;
+            next_chunk_ = chunks_count_;
+        }
+        if (++finished_ == chunks_count_) {
+            done_cv_.notify_all();
+        }
+    }
+}
+
+void ThreadPool::Batch::Wait() {
+    unique_lock lock(mutex_);
+    done_cv_.wait(lock, [this] { return finished_ == chunks_count_; });
+    if (error_) {
+        rethrow_exception(error_);
+    }
+}
+
+size_t ThreadPool::GetThreadsCount() const {
+    return workers_.size();
+}
+
+bool ThreadPool::TryPop(size_t index, function<void()>& task) {
+    {
+        WorkQueue& own = *queues_[index];
+        lock_guard lock(own.mutex_);
+        if (!own.tasks_.empty()) {
+            task = move(own.tasks_.back());
+            own.tasks_.pop_back();
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < queues_.size(); ++i) {
+        WorkQueue& other = *queues_[(index + i) % queues_.size()];
+        lock_guard lock(other.mutex_);
+        if (!other.tasks_.empty()) {
+            task = move(other.tasks_.front());
+            other.tasks_.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::WorkerLoop(size_t index) {
+    while (true) {
+        function<void()> task;
+        if (!TryPop(index, task)) {
+            unique_lock lock(state_mutex_);
+            sleeping_.fetch_add(1);
+            task_cv_.wait(lock, [this] { return stop_ || queued_.load() > 0; });
+            sleeping_.fetch_sub(1);
+            if (queued_.load() == 0) {
+                return;
+            }
+            continue;
+        }
+        queued_.fetch_sub(1);
+
+        try {
+            task();
+        } catch (...) {
+            lock_guard lock(state_mutex_);
+            if (!error_) {
+                error_ = current_exception();
+            }
+        }
+
+        if (unfinished_.fetch_sub(1) == 1) {
+            lock_guard lock(state_mutex_);
+            done_cv_.notify_all();
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads_count = std::thread::hardware_concurrency());
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    static ThreadPool& GetShared();
+
+    void Submit(std::function<void()> task);
+    void Wait();
+    size_t GetThreadsCount() const;
+
+    template <typename Func>
+    void ParallelFor(size_t count, Func func);
+
+private:
+    class Batch {
+    public:
+        explicit Batch(size_t chunks_count);
+
+        void Run(const std::function<void(size_t)>& run_chunk);
+        void Wait();
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable done_cv_;
+        size_t chunks_count_ = 0;
+        size_t next_chunk_ = 0;
+        size_t finished_ = 0;
+        std::exception_ptr error_;
+    };
+
+    struct WorkQueue {
+        std::mutex mutex_;
+        std::deque<std::function<void()>> tasks_;
+    };
+
+    void WorkerLoop(size_t index);
+    bool TryPop(size_t index, std::function<void()>& task);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> next_queue_ = 0;
+    std::atomic<size_t> queued_ = 0;
+    std::atomic<size_t> unfinished_ = 0;
+    std::atomic<size_t> sleeping_ = 0;
+
+    std::mutex state_mutex_;
+    std::condition_variable task_cv_;
+    std::condition_variable done_cv_;
+    bool stop_ = false;
+    std::exception_ptr error_;
+};
+
+template <typename Func>
+void ThreadPool::ParallelFor(size_t count, Func func) {
+    const size_t chunks_count = std::min(count, GetThreadsCount() * 4);
+    if (chunks_count == 0) {
+        return;
+    }
+    auto batch = std::make_shared<Batch>(chunks_count);
+    std::function<void(size_t)> run_chunk = [count, chunks_count, &func](size_t chunk) {
+        const size_t end = count * (chunk + 1) / chunks_count;
+        for (size_t i = count * chunk / chunks_count; i < end; ++i) {
+            func(i);
+        }
+    };
+    const size_t helpers_count = std::min(chunks_count, GetThreadsCount());
+    for (size_t helper = 1; helper < helpers_count; ++helper) {
+        Submit([batch, run_chunk] { batch->Run(run_chunk); });
+    }
+    batch->Run(run_chunk);
+    batch->Wait();
+}
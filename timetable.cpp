@@ -0,0 +1,261 @@
+#include "timetable.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+const double METERS_PER_KILOMETER = 1000.0;
+const double MINUTES_PER_HOUR = 60.0;
+const uint32_t MAX_ROUNDS = 8;
+const uint32_t NO_INDEX = numeric_limits<uint32_t>::max();
+const double NO_TIME = numeric_limits<double>::infinity();
+
+}
+
+Timetable::Timetable(const TransportCatalogue& transport_c, const RoutingSettings& settings,
+    const vector<BusSchedule>& schedules) {
+    if (settings.bus_velocity_ <= 0.0) {
+        throw invalid_argument("Bus velocity must be positive"s);
+    }
+
+    stops_ = transport_c.GetAllStops();
+    stops_indexes_.reserve(stops_.size());
+    for (size_t i = 0; i < stops_.size(); ++i) {
+        stops_indexes_[stops_[i]->name_] = static_cast<uint32_t>(i);
+    }
+
+    const double meters_per_minute = settings.bus_velocity_ * METERS_PER_KILOMETER / MINUTES_PER_HOUR;
+    for (const BusSchedule& schedule : schedules) {
+        const Bus* bus = transport_c.FindBus(schedule.bus_);
+        if (bus != nullptr && !schedule.departures_.empty()) {
+            AddRoutePattern(*bus, schedule.departures_, meters_per_minute);
+        }
+    }
+    IndexStopRoutes();
+}
+
+optional<JourneyInfo> Timetable::BuildJourney(string_view from, string_view to, double departure_time) const {
+    auto from_it = stops_indexes_.find(from);
+    auto to_it = stops_indexes_.find(to);
+    if (from_it == stops_indexes_.end() || to_it == stops_indexes_.end()) {
+        return nullopt;
+    }
+    const uint32_t source = from_it->second;
+    const uint32_t target = to_it->second;
+    const size_t stops_count = stops_.size();
+
+    thread_local Scratch scratch;
+    scratch.Prepare(stops_count, routes_.size());
+    vector<double>& arrivals = scratch.arrivals_;
+    vector<double>& best = scratch.best_;
+    vector<uint32_t>& improved_round = scratch.improved_round_;
+    vector<uint32_t>& first_positions = scratch.first_positions_;
+    vector<bool>& is_marked = scratch.is_marked_;
+    vector<uint32_t> queued_routes;
+    vector<uint32_t> marked{source};
+
+    arrivals[source] = departure_time;
+    best[source] = departure_time;
+    scratch.touched_arrivals_.push_back(source);
+    scratch.touched_stops_.push_back(source);
+
+    uint32_t last_round = 0;
+    for (uint32_t round = 1; round <= MAX_ROUNDS && !marked.empty(); ++round) {
+        const size_t round_offset = round * stops_count;
+        auto previous = [&](uint32_t stop) {
+            return improved_round[stop] == round ? scratch.before_round_[stop] : best[stop];
+        };
+
+        for (uint32_t stop : marked) {
+            is_marked[stop] = false;
+            for (uint32_t i = stop_routes_offsets_[stop]; i < stop_routes_offsets_[stop + 1]; ++i) {
+                const StopRoute& stop_route = stop_routes_[i];
+                if (first_positions[stop_route.route_] == NO_INDEX) {
+                    queued_routes.push_back(stop_route.route_);
+                }
+                first_positions[stop_route.route_] = min(first_positions[stop_route.route_], stop_route.position_);
+            }
+        }
+        marked.clear();
+
+        for (uint32_t route_index : queued_routes) {
+            const RoutePattern& route = routes_[route_index];
+            uint32_t trip = NO_INDEX;
+            uint32_t board_position = 0;
+            for (uint32_t position = first_positions[route_index]; position < route.stops_count_; ++position) {
+                const uint32_t stop = route_stops_[route.stops_begin_ + position];
+                const double* times = GetTimes(route, position);
+
+                if (trip != NO_INDEX && times[trip] < min(best[stop], best[target])) {
+                    if (improved_round[stop] != round) {
+                        if (best[stop] == NO_TIME) {
+                            scratch.touched_stops_.push_back(stop);
+                        }
+                        scratch.before_round_[stop] = best[stop];
+                        improved_round[stop] = round;
+                        scratch.touched_arrivals_.push_back(round_offset + stop);
+                    }
+                    arrivals[round_offset + stop] = times[trip];
+                    best[stop] = times[trip];
+                    scratch.labels_[round_offset + stop] = {route_index, trip, board_position, position};
+                    if (!is_marked[stop]) {
+                        is_marked[stop] = true;
+                        marked.push_back(stop);
+                    }
+                }
+
+                const double previous_arrival = previous(stop);
+                if (previous_arrival != NO_TIME && (trip == NO_INDEX || previous_arrival <= times[trip])) {
+                    const uint32_t earliest = static_cast<uint32_t>(
+                        lower_bound(times, times + route.trips_count_, previous_arrival) - times);
+                    if (earliest < route.trips_count_ && earliest != trip) {
+                        trip = earliest;
+                        board_position = position;
+                    }
+                }
+            }
+            first_positions[route_index] = NO_INDEX;
+        }
+        queued_routes.clear();
+
+        if (improved_round[target] == round) {
+            last_round = round;
+        }
+    }
+    for (uint32_t stop : marked) {
+        is_marked[stop] = false;
+    }
+
+    optional<JourneyInfo> result;
+    if (best[target] != NO_TIME) {
+        JourneyInfo& journey = result.emplace();
+        journey.arrival_time_ = best[target];
+        journey.total_time_ = best[target] - departure_time;
+        uint32_t stop = target;
+        for (uint32_t round = last_round; round > 0; --round) {
+            if (arrivals[round * stops_count + stop] == NO_TIME) {
+                continue;
+            }
+            const Label& label = scratch.labels_[round * stops_count + stop];
+            const RoutePattern& route = routes_[label.route_];
+            const double board_time = GetTimes(route, label.board_position_)[label.trip_];
+            const double alight_time = GetTimes(route, label.alight_position_)[label.trip_];
+            const uint32_t board_stop = route_stops_[route.stops_begin_ + label.board_position_];
+            uint32_t board_round = round - 1;
+            while (arrivals[board_round * stops_count + board_stop] == NO_TIME) {
+                --board_round;
+            }
+
+            journey.items_.push_back(RouteRide{route.bus_, static_cast<int>(label.alight_position_ - label.board_position_),
+                alight_time - board_time});
+            journey.items_.push_back(RouteWait{stops_[board_stop],
+                board_time - arrivals[board_round * stops_count + board_stop]});
+            stop = board_stop;
+        }
+        reverse(journey.items_.begin(), journey.items_.end());
+    }
+    scratch.Reset();
+    return result;
+}
+
+size_t Timetable::GetTripsCount() const {
+    size_t trips_count = 0;
+    for (const RoutePattern& route : routes_) {
+        trips_count += route.trips_count_;
+    }
+    return trips_count;
+}
+
+void Timetable::AddRoutePattern(const Bus& bus, const vector<double>& departures, double meters_per_minute) {
+    RoutePattern route;
+    route.bus_ = &bus;
+    route.stops_begin_ = static_cast<uint32_t>(route_stops_.size());
+    route.times_begin_ = stop_times_.size();
+
+    vector<double> offsets;
+    for (size_t i = 0; i < bus.route_.size(); ++i) {
+        if (i == 0) {
+            offsets.push_back(0.0);
+        } else {
+            auto distance_it = bus.route_[i - 1]->neighbor_stops_dist_.find(bus.route_[i]);
+            if (distance_it == bus.route_[i - 1]->neighbor_stops_dist_.end()) {
+                break;
+            }
+            offsets.push_back(offsets.back() + distance_it->second / meters_per_minute);
+        }
+        route_stops_.push_back(stops_indexes_.at(bus.route_[i]->name_));
+    }
+    if (offsets.size() < 2) {
+        route_stops_.resize(route.stops_begin_);
+        return;
+    }
+
+    vector<double> sorted_departures = departures;
+    sort(sorted_departures.begin(), sorted_departures.end());
+    route.stops_count_ = static_cast<uint32_t>(offsets.size());
+    route.trips_count_ = static_cast<uint32_t>(sorted_departures.size());
+    stop_times_.reserve(stop_times_.size() + offsets.size() * sorted_departures.size());
+    for (double offset : offsets) {
+        for (double departure : sorted_departures) {
+            stop_times_.push_back(departure + offset);
+        }
+    }
+    routes_.push_back(route);
+}
+
+void Timetable::IndexStopRoutes() {
+    stop_routes_offsets_.assign(stops_.size() + 1, 0);
+    for (const RoutePattern& route : routes_) {
+        for (uint32_t position = 0; position < route.stops_count_; ++position) {
+            ++stop_routes_offsets_[route_stops_[route.stops_begin_ + position] + 1];
+        }
+    }
+    for (size_t i = 1; i < stop_routes_offsets_.size(); ++i) {
+        stop_routes_offsets_[i] += stop_routes_offsets_[i - 1];
+    }
+
+    stop_routes_.resize(stop_routes_offsets_.back());
+    vector<uint32_t> filled(stop_routes_offsets_.begin(), stop_routes_offsets_.end() - 1);
+    for (uint32_t route_index = 0; route_index < routes_.size(); ++route_index) {
+        const RoutePattern& route = routes_[route_index];
+        for (uint32_t position = 0; position < route.stops_count_; ++position) {
+            const uint32_t stop = route_stops_[route.stops_begin_ + position];
+            stop_routes_[filled[stop]++] = {route_index, position};
+        }
+    }
+}
+
+const double* Timetable::GetTimes(const RoutePattern& route, uint32_t position) const {
+    return stop_times_.data() + route.times_begin_ + static_cast<uint64_t>(position) * route.trips_count_;
+}
+
+void Timetable::Scratch::Prepare(size_t stops_count, size_t routes_count) {
+    if (arrivals_.size() < (MAX_ROUNDS + 1) * stops_count) {
+        arrivals_.resize((MAX_ROUNDS + 1) * stops_count, NO_TIME);
+        labels_.resize((MAX_ROUNDS + 1) * stops_count);
+    }
+    if (best_.size() < stops_count) {
+        best_.resize(stops_count, NO_TIME);
+        before_round_.resize(stops_count, NO_TIME);
+        improved_round_.resize(stops_count, 0);
+        is_marked_.resize(stops_count, false);
+    }
+    if (first_positions_.size() < routes_count) {
+        first_positions_.resize(routes_count, NO_INDEX);
+    }
+}
+
+void Timetable::Scratch::Reset() {
+    for (size_t arrival : touched_arrivals_) {
+        arrivals_[arrival] = NO_TIME;
+    }
+    for (uint32_t stop : touched_stops_) {
+        best_[stop] = NO_TIME;
+        improved_round_[stop] = 0;
+    }
+    touched_arrivals_.clear();
+    touched_stops_.clear();
+}
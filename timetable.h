@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+struct BusSchedule {
+    std::string bus_;
+    std::vector<double> departures_;
+};
+
+struct JourneyInfo : RouteInfo {
+    double arrival_time_ = 0.0;
+};
+
+class Timetable {
+public:
+    Timetable(const TransportCatalogue& transport_c, const RoutingSettings& settings,
+        const std::vector<BusSchedule>& schedules);
+    Timetable(const Timetable&) = delete;
+    Timetable& operator=(const Timetable&) = delete;
+
+    std::optional<JourneyInfo> BuildJourney(std::string_view from, std::string_view to, double departure_time) const;
+    size_t GetTripsCount() const;
+
+private:
+    struct RoutePattern {
+        const Bus* bus_ = nullptr;
+        uint32_t stops_begin_ = 0;
+        uint32_t stops_count_ = 0;
+        uint64_t times_begin_ = 0;
+        uint32_t trips_count_ = 0;
+    };
+
+    struct StopRoute {
+        uint32_t route_ = 0;
+        uint32_t position_ = 0;
+    };
+
+    struct Label {
+        uint32_t route_;
+        uint32_t trip_;
+        uint32_t board_position_;
+        uint32_t alight_position_;
+    };
+
+    struct Scratch {
+        std::vector<double> arrivals_;
+        std::vector<Label> labels_;
+        std::vector<double> best_;
+        std::vector<double> before_round_;
+        std::vector<uint32_t> improved_round_;
+        std::vector<uint32_t> first_positions_;
+        std::vector<bool> is_marked_;
+        std::vector<uint32_t> touched_stops_;
+        std::vector<size_t> touched_arrivals_;
+
+        void Prepare(size_t stops_count, size_t routes_count);
+        void Reset();
+    };
+
+    void AddRoutePattern(const Bus& bus, const std::vector<double>& departures, double meters_per_minute);
+    void IndexStopRoutes();
+    const double* GetTimes(const RoutePattern& route, uint32_t position) const;
+
+    std::vector<const Stop*> stops_;
+    std::unordered_map<std::string_view, uint32_t> stops_indexes_;
+    std::vector<RoutePattern> routes_;
+    std::vector<uint32_t> route_stops_;
+    std::vector<double> stop_times_;
+    std::vector<uint32_t> stop_routes_offsets_;
+    std::vector<StopRoute> stop_routes_;
+};
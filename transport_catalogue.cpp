@@ -1,15 +1,54 @@
 #include "transport_catalogue.h"
 #include <unordered_set>
 #include <algorithm>
+#include <numeric>
 
 using namespace std;
 
+namespace {
+
+const uint32_t HILBERT_SIDE = 1u << 16;
+
+uint64_t ComputeHilbertIndex(uint32_t x, uint32_t y) {
+    uint64_t result = 0;
+    for (uint32_t side = HILBERT_SIDE / 2; side > 0; side /= 2) {
+        const uint32_t rx = (x & side) > 0 ? 1 : 0;
+        const uint32_t ry = (y & side) > 0 ? 1 : 0;
+        result += static_cast<uint64_t>(side) * side * ((3 * rx) ^ ry);
+        if (ry == 0) {
+            if (rx == 1) {
+                x = HILBERT_SIDE - 1 - x;
+                y = HILBERT_SIDE - 1 - y;
+            }
+            swap(x, y);
+        }
+    }
+    return result;
+}
+
+uint32_t ToHilbertCell(double value, double min_value, double span) {
+    if (Geo::IsZero(span)) {
+        return 0;
+    }
+    return static_cast<uint32_t>((value - min_value) / span * (HILBERT_SIDE - 1));
+}
+
+}
+
+TransportCatalogue::TransportCatalogue() : TransportCatalogue(Geo::CoordinatesEncoding::Double) {}
+
+TransportCatalogue::TransportCatalogue(Geo::CoordinatesEncoding encoding)
+: stops_coords_(make_unique<Geo::CoordinatesArray>(encoding)) {}
+
 const Stop& TransportCatalogue::AddStop(const string_view &stop, Geo::Coordinates coordinates) {
     string stop_str(stop);
     if (stops_ptrs_.contains(stop)) {
         throw invalid_argument("Attempt to add existing stop: "s + stop_str + '\n');
     }
-    Stop& new_stop_ref = stops_.emplace_front(move(stop_str), coordinates);
+    stops_coords_->PushBack(coordinates);
+    Stop& new_stop_ref = stops_.emplace_back(move(stop_str), stops_coords_.get(),
+        static_cast<uint32_t>(stops_coords_->GetSize() - 1));
+    stops_distances_.PushBack(new_stop_ref.GetCoordinates());
     stops_ptrs_[new_stop_ref.name_] = &new_stop_ref;
 
     return new_stop_ref;
@@ -21,31 +60,124 @@ void TransportCatalogue::AddBus(const string_view &bus, const vector<std::string
         throw invalid_argument("Attempt to add existing bus: "s + bus_str + '\n');
     }
 
-    vector<Stop*> new_route;
-    new_route.reserve(route.size());
-    for (const string_view& stop : route) {
-        Stop* stop_ptr = stops_ptrs_.at(stop);
-        new_route.emplace_back(stop_ptr);
-    }
-
-    Bus& new_bus = buses_.emplace_front(move(bus_str), move(new_route), is_round);
-    for (auto& stop : new_bus.route_) {
-        stops_routes_ptrs_[stop->name_].insert(&new_bus);
-    }
-    buses_ptrs_[new_bus.name_] = &new_bus;
+    Bus& new_bus = buses_.emplace_front(move(bus_str), GetRoutePtrs(route), is_round);
+    buses_ptrs_[new_bus.name_] = buses_.begin();
+    LinkRoute(new_bus);
+    RefreshStatistics(new_bus);
 }
 
 void TransportCatalogue::AddNeighborStopDistance(std::string_view stop_target_str, 
     std::string_view stop_neighbor_str, 
     uint32_t distance) {
-        auto stop_target = stops_ptrs_.find(stop_target_str)->second;
-        auto stop_neighbor = stops_ptrs_.find(stop_neighbor_str)->second;
+        SetDistance(stops_ptrs_.find(stop_target_str)->second, stops_ptrs_.find(stop_neighbor_str)->second, distance);
+}
+
+void TransportCatalogue::RemoveBus(string_view bus) {
+    auto it = buses_ptrs_.find(bus);
+    if (it == buses_ptrs_.end()) {
+        throw invalid_argument("Attempt to remove unknown bus: "s + string(bus) + '\n');
+    }
 
-        stop_target->AddNeighborStop(stop_neighbor, distance);
+    auto bus_it = it->second;
+    UnlinkRoute(*bus_it);
+    routes_statistics_.erase(&*bus_it);
+    buses_ptrs_.erase(it);
+    buses_.erase(bus_it);
+}
+
+void TransportCatalogue::UpdateBusRoute(string_view bus, const vector<string_view>& route, bool is_round) {
+    auto it = buses_ptrs_.find(bus);
+    if (it == buses_ptrs_.end()) {
+        throw invalid_argument("Attempt to update unknown bus: "s + string(bus) + '\n');
+    }
+    if (route.empty()) {
+        throw invalid_argument("Attempt to set empty route for bus: "s + string(bus) + '\n');
+    }
+
+    vector<Stop*> new_route = GetRoutePtrs(route);
+    Bus& bus_ref = *it->second;
+    UnlinkRoute(bus_ref);
+    bus_ref.route_ = move(new_route);
+    bus_ref.is_round_ = is_round;
+    LinkRoute(bus_ref);
+    RefreshStatistics(bus_ref);
+}
+
+void TransportCatalogue::MoveStop(string_view stop, Geo::Coordinates coordinates) {
+    Stop* stop_ptr = GetStopPtr(stop);
+    stops_coords_->Set(stop_ptr->index_, coordinates);
+    stops_distances_.Set(stop_ptr->index_, stop_ptr->GetCoordinates());
+    RefreshStatistics(*stop_ptr);
+}
+
+void TransportCatalogue::UpdateDistance(string_view stop_from, string_view stop_to, uint32_t distance) {
+    SetDistance(GetStopPtr(stop_from), GetStopPtr(stop_to), distance);
+}
 
-        if (!stop_neighbor->neighbor_stops_dist_.contains(stop_target)) {
-            stop_neighbor->AddNeighborStop(stop_target, distance);
+void TransportCatalogue::ReorderStopsAlongHilbertCurve() {
+    if (stops_.empty()) {
+        return;
+    }
+
+    const auto [bottom_it, top_it] = minmax_element(stops_.begin(), stops_.end(),
+        [](const Stop& lhs, const Stop& rhs) { return lhs.GetCoordinates().lat < rhs.GetCoordinates().lat; });
+    const auto [left_it, right_it] = minmax_element(stops_.begin(), stops_.end(),
+        [](const Stop& lhs, const Stop& rhs) { return lhs.GetCoordinates().lng < rhs.GetCoordinates().lng; });
+    const double min_lat = bottom_it->GetCoordinates().lat;
+    const double lat_span = top_it->GetCoordinates().lat - min_lat;
+    const double min_lng = left_it->GetCoordinates().lng;
+    const double lng_span = right_it->GetCoordinates().lng - min_lng;
+
+    vector<pair<uint64_t, Stop*>> ordered;
+    ordered.reserve(stops_ptrs_.size());
+    for (Stop& stop : stops_) {
+        const Geo::Coordinates coords = stop.GetCoordinates();
+        ordered.emplace_back(ComputeHilbertIndex(ToHilbertCell(coords.lng, min_lng, lng_span),
+            ToHilbertCell(coords.lat, min_lat, lat_span)), &stop);
+    }
+    sort(ordered.begin(), ordered.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first < rhs.first || (lhs.first == rhs.first && lhs.second->name_ < rhs.second->name_);
+    });
+
+    deque<Stop> reordered;
+    unordered_map<const Stop*, Stop*> relocated;
+    relocated.reserve(ordered.size());
+    Geo::CoordinatesArray reordered_coords(stops_coords_->GetEncoding());
+    reordered_coords.Reserve(ordered.size());
+    for (const auto& [index, stop] : ordered) {
+        reordered_coords.PushBack(stop->GetCoordinates());
+        relocated[stop] = &reordered.emplace_back(string(stop->name_), stops_coords_.get(),
+            static_cast<uint32_t>(reordered.size()));
+    }
+    *stops_coords_ = move(reordered_coords);
+    stops_distances_ = Geo::DistanceTable(*stops_coords_);
+    for (const auto& [index, stop] : ordered) {
+        Stop* new_stop = relocated.at(stop);
+        new_stop->neighbor_stops_dist_.reserve(stop->neighbor_stops_dist_.size());
+        for (const auto& [neighbor, distance] : stop->neighbor_stops_dist_) {
+            new_stop->neighbor_stops_dist_[relocated.at(neighbor)] = distance;
+        }
+        for (const Stop* neighbor : stop->implied_neighbors_) {
+            new_stop->implied_neighbors_.insert(relocated.at(neighbor));
+        }
+    }
+
+    unordered_map<string_view, BusPtrsSet> stops_routes_ptrs;
+    for (auto& [name, buses] : stops_routes_ptrs_) {
+        stops_routes_ptrs[relocated.at(stops_ptrs_.at(name))->name_] = move(buses);
+    }
+    for (Bus& bus : buses_) {
+        for (Stop*& stop : bus.route_) {
+            stop = relocated.at(stop);
         }
+    }
+
+    stops_ptrs_.clear();
+    for (Stop& stop : reordered) {
+        stops_ptrs_[stop.name_] = &stop;
+    }
+    stops_routes_ptrs_ = move(stops_routes_ptrs);
+    stops_ = move(reordered);
 }
 
 optional<RouteStatistics> TransportCatalogue::GetRouteStatistics(string_view bus) const {
@@ -54,14 +186,7 @@ optional<RouteStatistics> TransportCatalogue::GetRouteStatistics(string_view bus
         return {};
     }
 
-    const vector<Stop*>& route = it->second->route_;
-    unordered_set<Stop*> unique_stops_(route.begin(), route.end());
-    double real_distance = GetRealRouteLength(bus);
-
-    return optional(RouteStatistics{(real_distance),
-                                    static_cast<int>(route.size()), 
-                                    static_cast<int>(unique_stops_.size()),
-                                    static_cast<double> (real_distance / GetRouteLength(bus)) });
+    return routes_statistics_.at(&*it->second);
 }
 
 const Bus* TransportCatalogue::FindBus(string_view bus) const {
@@ -70,7 +195,7 @@ const Bus* TransportCatalogue::FindBus(string_view bus) const {
         return nullptr;
     }
     
-    return result->second;
+    return &*result->second;
 }
 
 const Stop* TransportCatalogue::FindStop(string_view stop) const {
@@ -99,22 +224,35 @@ vector<const Bus*> TransportCatalogue::GetAllBuses() const {
     return result;
 }
 
-double TransportCatalogue::GetRouteLength(string_view bus) const {
-    const Bus* bus_ptr = buses_ptrs_.at(bus);
-    const vector<Stop*>& route = bus_ptr->route_;
-    double sum = 0.0;
-    for (size_t i = 1; i < route.size(); i++) {
-        auto& prev = stops_ptrs_.at(route.at(i - 1)->name_)->coords_;
-        auto& cur = stops_ptrs_.at(route.at(i)->name_)->coords_;
-        sum += ComputeDistance(prev, cur);
+vector<const Stop*> TransportCatalogue::GetAllStops() const {
+    vector<const Stop*> result;
+    for (auto& stop : stops_) {
+        result.push_back(&stop);
     }
+    return result;
+}
 
-    return sum;
+const Geo::CoordinatesArray& TransportCatalogue::GetStopsCoordinates() const {
+    return *stops_coords_;
+}
+
+double TransportCatalogue::GetRouteLength(string_view bus) const {
+    const vector<Stop*>& route = buses_ptrs_.at(bus)->route_;
+    if (route.size() < 2) {
+        return 0.0;
+    }
+    vector<uint32_t> indexes;
+    indexes.reserve(route.size());
+    for (const Stop* stop : route) {
+        indexes.push_back(stop->index_);
+    }
+    vector<double> distances(route.size() - 1);
+    stops_distances_.ComputeDistances(indexes.data(), indexes.data() + 1, distances.data(), distances.size());
+    return accumulate(distances.begin(), distances.end(), 0.0);
 }
 
 double TransportCatalogue::GetRealRouteLength(std::string_view bus) const {
-    const Bus* bus_ptr = buses_ptrs_.at(bus);
-    const vector<Stop*>& stops = bus_ptr->route_;
+    const vector<Stop*>& stops = buses_ptrs_.at(bus)->route_;
     double total_distance = 0;
 
     for (int i = 0; i < static_cast<int>(stops.size()) - 1; i++) {
@@ -126,8 +264,77 @@ double TransportCatalogue::GetRealRouteLength(std::string_view bus) const {
             return 0;
         }
 
-        total_distance += curr_stop->neighbor_stops_dist_[next_stop];
+        total_distance += nightbor_stop_it->second;
     }
 
     return total_distance;
 }
+
+Stop* TransportCatalogue::GetStopPtr(string_view stop) const {
+    auto it = stops_ptrs_.find(stop);
+    if (it == stops_ptrs_.end()) {
+        throw invalid_argument("Unknown stop: "s + string(stop) + '\n');
+    }
+    return it->second;
+}
+
+vector<Stop*> TransportCatalogue::GetRoutePtrs(const vector<string_view>& route) const {
+    vector<Stop*> route_ptrs;
+    route_ptrs.reserve(route.size());
+    for (const string_view& stop : route) {
+        route_ptrs.emplace_back(GetStopPtr(stop));
+    }
+    return route_ptrs;
+}
+
+void TransportCatalogue::LinkRoute(Bus& bus) {
+    for (auto& stop : bus.route_) {
+        stops_routes_ptrs_[stop->name_].insert(&bus);
+    }
+}
+
+void TransportCatalogue::UnlinkRoute(const Bus& bus) {
+    for (auto& stop : bus.route_) {
+        auto it = stops_routes_ptrs_.find(stop->name_);
+        if (it == stops_routes_ptrs_.end()) {
+            continue;
+        }
+        it->second.erase(&bus);
+        if (it->second.empty()) {
+            stops_routes_ptrs_.erase(it);
+        }
+    }
+}
+
+void TransportCatalogue::SetDistance(Stop* stop_from, Stop* stop_to, uint32_t distance) {
+    stop_from->AddNeighborStop(stop_to, distance);
+    stop_from->implied_neighbors_.erase(stop_to);
+
+    if (!stop_to->neighbor_stops_dist_.contains(stop_from) || stop_to->implied_neighbors_.contains(stop_from)) {
+        stop_to->AddNeighborStop(stop_from, distance);
+        stop_to->implied_neighbors_.insert(stop_from);
+        RefreshStatistics(*stop_to);
+    }
+    RefreshStatistics(*stop_from);
+}
+
+void TransportCatalogue::RefreshStatistics(const Bus& bus) {
+    const vector<Stop*>& route = bus.route_;
+    unordered_set<Stop*> unique_stops_(route.begin(), route.end());
+    double real_distance = GetRealRouteLength(bus.name_);
+
+    routes_statistics_[&bus] = RouteStatistics{(real_distance),
+                                    static_cast<int>(route.size()), 
+                                    static_cast<int>(unique_stops_.size()),
+                                    static_cast<double> (real_distance / GetRouteLength(bus.name_)) };
+}
+
+void TransportCatalogue::RefreshStatistics(const Stop& stop) {
+    auto it = stops_routes_ptrs_.find(stop.name_);
+    if (it == stops_routes_ptrs_.end()) {
+        return;
+    }
+    for (const Bus* bus : it->second) {
+        RefreshStatistics(*bus);
+    }
+}
@@ -1,7 +1,9 @@
 #pragma once
 #include <sstream>
 #include <stdexcept>
-#include <forward_list>
+#include <deque>
+#include <list>
+#include <memory>
 #include <optional>
 #include"domain.h"
 
@@ -10,29 +12,51 @@ using namespace std::string_literals;
 class TransportCatalogue {
 
 public:
-	TransportCatalogue() = default;
+	TransportCatalogue();
+	explicit TransportCatalogue(Geo::CoordinatesEncoding encoding);
 
 	[[maybe_unused]] const Stop& AddStop(const std::string_view& stop, Geo::Coordinates coordinates);
 	void AddBus(const std::string_view& bus, const std::vector<std::string_view>& route, bool is_round = false);
 
 	void AddNeighborStopDistance(std::string_view stop_target, std::string_view stop_neighbor,
 	uint32_t distance);
+
+	void RemoveBus(std::string_view bus);
+	void UpdateBusRoute(std::string_view bus, const std::vector<std::string_view>& route, bool is_round = false);
+	void MoveStop(std::string_view stop, Geo::Coordinates coordinates);
+	void UpdateDistance(std::string_view stop_from, std::string_view stop_to, uint32_t distance);
+	void ReorderStopsAlongHilbertCurve();
+
 	std::optional<RouteStatistics> GetRouteStatistics(std::string_view bus) const;
 	const Bus* FindBus(std::string_view bus) const;
 	const Stop* FindStop(std::string_view stop) const;
 	const BusPtrsSet* FindBuses(std::string_view stop) const;
 	std::vector<const Bus*> GetAllBuses() const;
+	std::vector<const Stop*> GetAllStops() const;
+	const Geo::CoordinatesArray& GetStopsCoordinates() const;
 
 protected:
-	std::forward_list<Stop> stops_;
-	std::forward_list<Bus> buses_;
+	std::deque<Stop> stops_;
+	std::unique_ptr<Geo::CoordinatesArray> stops_coords_;
+	Geo::DistanceTable stops_distances_;
+	std::list<Bus> buses_;
 	std::unordered_map<std::string_view, Stop*> stops_ptrs_;
-	std::unordered_map<std::string_view, Bus*> buses_ptrs_;
+	std::unordered_map<std::string_view, std::list<Bus>::iterator> buses_ptrs_;
 
 	std::unordered_map<std::string_view, BusPtrsSet> stops_routes_ptrs_;
+	std::unordered_map<const Bus*, RouteStatistics> routes_statistics_;
 
 	double GetRouteLength(std::string_view bus) const;
 	double GetRealRouteLength(std::string_view bus) const;
 
+private:
+	Stop* GetStopPtr(std::string_view stop) const;
+	std::vector<Stop*> GetRoutePtrs(const std::vector<std::string_view>& route) const;
+	void LinkRoute(Bus& bus);
+	void UnlinkRoute(const Bus& bus);
+	void SetDistance(Stop* stop_from, Stop* stop_to, uint32_t distance);
+	void RefreshStatistics(const Bus& bus);
+	void RefreshStatistics(const Stop& stop);
+
 	Stop empty_stop_;
 };
@@ -0,0 +1,270 @@
+#include "transport_router.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+
+using namespace std;
+
+namespace {
+
+const double METERS_PER_KILOMETER = 1000.0;
+const double MINUTES_PER_HOUR = 60.0;
+
+graph::VertexId WaitVertex(graph::VertexId stop_index) {
+    return stop_index * 2;
+}
+
+graph::VertexId RideVertex(graph::VertexId stop_index) {
+    return stop_index * 2 + 1;
+}
+
+}
+
+size_t TravelMatrix::GetRowsCount() const {
+    return columns_count_ == 0 ? 0 : times_.size() / columns_count_;
+}
+
+double TravelMatrix::GetTime(size_t row, size_t column) const {
+    return times_[row * columns_count_ + column];
+}
+
+double TravelMatrix::GetDistance(size_t row, size_t column) const {
+    return distances_[row * columns_count_ + column];
+}
+
+bool TravelMatrix::HasRoute(size_t row, size_t column) const {
+    return GetTime(row, column) != numeric_limits<double>::infinity();
+}
+
+TransportRouter::TransportRouter(const TransportCatalogue& transport_c, RoutingSettings settings)
+    : settings_(settings)
+    , router_(graph_) {
+    if (settings_.bus_velocity_ <= 0.0) {
+        throw invalid_argument("Bus velocity must be positive"s);
+    }
+
+    stops_ = transport_c.GetAllStops();
+    graph_ = graph::DirectedWeightedGraph<double>(stops_.size() * 2);
+    stops_vertexes_.reserve(stops_.size());
+    for (size_t i = 0; i < stops_.size(); ++i) {
+        stops_vertexes_[stops_[i]->name_] = i;
+    }
+    stops_distances_ = Geo::DistanceTable(transport_c.GetStopsCoordinates(), settings_.distance_mode_);
+
+    AddWaitEdges(stops_);
+    const double meters_per_minute = settings_.bus_velocity_ * METERS_PER_KILOMETER / MINUTES_PER_HOUR;
+    double road_to_geo_ratio = numeric_limits<double>::infinity();
+    for (const Bus* bus : transport_c.GetAllBuses()) {
+        AddRideEdges(*bus);
+        for (size_t i = 0; i + 1 < bus->route_.size(); ++i) {
+            const double geo_distance = stops_distances_.ComputeDistance(
+                static_cast<uint32_t>(stops_vertexes_.at(bus->route_[i]->name_)),
+                static_cast<uint32_t>(stops_vertexes_.at(bus->route_[i + 1]->name_)));
+            auto distance_it = bus->route_[i]->neighbor_stops_dist_.find(bus->route_[i + 1]);
+            if (distance_it != bus->route_[i]->neighbor_stops_dist_.end() && geo_distance > 0.0) {
+                road_to_geo_ratio = min(road_to_geo_ratio, distance_it->second / geo_distance);
+            }
+        }
+    }
+    if (road_to_geo_ratio != numeric_limits<double>::infinity()) {
+        minutes_per_geo_meter_ = road_to_geo_ratio / meters_per_minute;
+    }
+}
+
+TransportRouter::TransportRouter(const TransportCatalogue& transport_c, RoutingSettings settings, ThreadPool& pool)
+    : TransportRouter(transport_c, settings) {
+    if (settings_.landmarks_count_ > 0) {
+        BuildLandmarks(settings_.landmarks_count_, pool);
+    }
+}
+
+optional<RouteInfo> TransportRouter::BuildRoute(string_view from, string_view to) const {
+    auto from_it = stops_vertexes_.find(from);
+    auto to_it = stops_vertexes_.find(to);
+    if (from_it == stops_vertexes_.end() || to_it == stops_vertexes_.end()) {
+        return nullopt;
+    }
+
+    const graph::VertexId from_vertex = WaitVertex(from_it->second);
+    const graph::VertexId to_vertex = WaitVertex(to_it->second);
+    auto route = hierarchy_ ? hierarchy_->BuildRoute(from_vertex, to_vertex)
+        : landmarks_ ? landmarks_->BuildRoute(from_vertex, to_vertex)
+        : router_.BuildRoute(from_vertex, to_vertex);
+    if (!route) {
+        return nullopt;
+    }
+
+    RouteInfo result{route->weight_, {}};
+    result.items_.reserve(route->edges_.size());
+    for (graph::EdgeId edge_id : route->edges_) {
+        const EdgeInfo& info = edges_info_[edge_id];
+        const double time = graph_.GetEdge(edge_id).weight_;
+        if (info.bus_ == nullptr) {
+            result.items_.push_back(RouteWait{info.stop_, time});
+        } else {
+            result.items_.push_back(RouteRide{info.bus_, info.span_count_, time});
+        }
+    }
+    return result;
+}
+
+optional<vector<ReachableStop>> TransportRouter::BuildIsochrone(string_view from, double time_limit) const {
+    auto from_it = stops_vertexes_.find(from);
+    if (from_it == stops_vertexes_.end()) {
+        return nullopt;
+    }
+
+    const auto tree = router_.BuildTree(WaitVertex(from_it->second), time_limit);
+    vector<ReachableStop> result;
+    for (size_t i = 0; i < stops_.size(); ++i) {
+        const double time = tree.weights_[WaitVertex(i)];
+        if (time <= time_limit) {
+            result.push_back({stops_[i], time});
+        }
+    }
+    sort(result.begin(), result.end(), [](const ReachableStop& lhs, const ReachableStop& rhs) {
+        return tie(lhs.time_, lhs.stop_->name_) < tie(rhs.time_, rhs.stop_->name_);
+    });
+    return result;
+}
+
+TravelMatrix TransportRouter::BuildMatrix(const vector<string_view>& origins,
+    const vector<string_view>& destinations, ThreadPool& pool) const {
+    vector<graph::VertexId> origin_vertexes;
+    origin_vertexes.reserve(origins.size());
+    for (string_view name : origins) {
+        origin_vertexes.push_back(GetStopVertex(name));
+    }
+    vector<graph::VertexId> destination_vertexes;
+    destination_vertexes.reserve(destinations.size());
+    for (string_view name : destinations) {
+        destination_vertexes.push_back(GetStopVertex(name));
+    }
+
+    const size_t columns_count = destinations.size();
+    TravelMatrix matrix{columns_count,
+        vector<double>(origins.size() * columns_count, numeric_limits<double>::infinity()),
+        vector<double>(origins.size() * columns_count, numeric_limits<double>::infinity())};
+
+    pool.ParallelFor(origins.size(), [&](size_t row) {
+        const graph::VertexId from = origin_vertexes[row];
+        const auto tree = router_.BuildTree(from);
+        for (size_t column = 0; column < columns_count; ++column) {
+            graph::VertexId vertex = destination_vertexes[column];
+            if (tree.weights_[vertex] == graph::Router<double>::UNREACHABLE) {
+                continue;
+            }
+            matrix.times_[row * columns_count + column] = tree.weights_[vertex];
+            double distance = 0.0;
+            for (; vertex != from; vertex = graph_.GetEdge(tree.prev_edges_[vertex]).from_) {
+                distance += edges_info_[tree.prev_edges_[vertex]].distance_;
+            }
+            matrix.distances_[row * columns_count + column] = distance;
+        }
+    });
+    return matrix;
+}
+
+bool TransportRouter::HasStop(string_view name) const {
+    return stops_vertexes_.contains(name);
+}
+
+const RoutingSettings& TransportRouter::GetSettings() const {
+    return settings_;
+}
+
+void TransportRouter::BuildHierarchy() {
+    hierarchy_ = make_unique<graph::ContractionHierarchy>(graph_);
+}
+
+void TransportRouter::SaveHierarchy(ostream& out) const {
+    if (!hierarchy_) {
+        throw logic_error("The contraction hierarchy is not built"s);
+    }
+    hierarchy_->Save(out);
+}
+
+void TransportRouter::LoadHierarchy(istream& in) {
+    hierarchy_ = make_unique<graph::ContractionHierarchy>(graph_, in);
+}
+
+bool TransportRouter::HasHierarchy() const {
+    return hierarchy_ != nullptr;
+}
+
+void TransportRouter::BuildLandmarks(size_t landmarks_count, ThreadPool& pool) {
+    landmarks_ = make_unique<graph::LandmarkRouter>(graph_, SelectLandmarks(landmarks_count), pool,
+        [this](graph::VertexId from, graph::VertexId to) {
+            return ComputeTimeLowerBound(from, to);
+        });
+}
+
+bool TransportRouter::HasLandmarks() const {
+    return landmarks_ != nullptr;
+}
+
+graph::VertexId TransportRouter::GetStopVertex(string_view name) const {
+    auto it = stops_vertexes_.find(name);
+    if (it == stops_vertexes_.end()) {
+        throw invalid_argument("Unknown stop: "s + string(name));
+    }
+    return WaitVertex(it->second);
+}
+
+vector<graph::VertexId> TransportRouter::SelectLandmarks(size_t landmarks_count) const {
+    vector<uint32_t> candidates;
+    for (size_t i = 0; i < stops_.size(); ++i) {
+        if (!graph_.GetIncidentEdges(RideVertex(i)).empty()) {
+            candidates.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    vector<graph::VertexId> landmarks;
+    vector<double> nearest(candidates.size(), numeric_limits<double>::infinity());
+    vector<double> distances(candidates.size());
+    size_t next = 0;
+    while (landmarks.size() < min(landmarks_count, candidates.size()) && nearest[next] > 0.0) {
+        landmarks.push_back(WaitVertex(candidates[next]));
+        stops_distances_.ComputeDistances(candidates[next], candidates.data(), distances.data(), candidates.size());
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            nearest[i] = min(nearest[i], distances[i]);
+        }
+        next = max_element(nearest.begin(), nearest.end()) - nearest.begin();
+    }
+    return landmarks;
+}
+
+double TransportRouter::ComputeTimeLowerBound(graph::VertexId from, graph::VertexId to) const {
+    const double distance = stops_distances_.ComputeDistance(static_cast<uint32_t>(from / 2), static_cast<uint32_t>(to / 2));
+    return distance > 0.0 ? distance * minutes_per_geo_meter_ : 0.0;
+}
+
+void TransportRouter::AddWaitEdges(const vector<const Stop*>& stops) {
+    for (size_t i = 0; i < stops.size(); ++i) {
+        graph_.AddEdge({WaitVertex(i), RideVertex(i), settings_.bus_wait_time_});
+        edges_info_.push_back({stops[i], nullptr, 0, 0.0});
+    }
+}
+
+void TransportRouter::AddRideEdges(const Bus& bus) {
+    const double meters_per_minute = settings_.bus_velocity_ * METERS_PER_KILOMETER / MINUTES_PER_HOUR;
+    const vector<Stop*>& route = bus.route_;
+
+    for (size_t i = 0; i + 1 < route.size(); ++i) {
+        const graph::VertexId from = RideVertex(stops_vertexes_.at(route[i]->name_));
+        double distance = 0.0;
+        for (size_t j = i + 1; j < route.size(); ++j) {
+            auto distance_it = route[j - 1]->neighbor_stops_dist_.find(route[j]);
+            if (distance_it == route[j - 1]->neighbor_stops_dist_.end()) {
+                break;
+            }
+            distance += distance_it->second;
+            if (route[j] == route[i]) {
+                continue;
+            }
+            graph_.AddEdge({from, WaitVertex(stops_vertexes_.at(route[j]->name_)), distance / meters_per_minute});
+            edges_info_.push_back({route[i], &bus, static_cast<int>(j - i), distance});
+        }
+    }
+}
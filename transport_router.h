@@ -0,0 +1,103 @@
+#pragma once
+#include <iosfwd>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "transport_catalogue.h"
+#include "router.h"
+#include "contraction_hierarchy.h"
+#include "landmark_router.h"
+#include "thread_pool.h"
+
+struct RoutingSettings {
+    double bus_wait_time_ = 0.0;
+    double bus_velocity_ = 0.0;
+    size_t landmarks_count_ = 0;
+    Geo::DistanceMode distance_mode_ = Geo::DistanceMode::Exact;
+};
+
+struct RouteWait {
+    const Stop* stop_ = nullptr;
+    double time_ = 0.0;
+};
+
+struct RouteRide {
+    const Bus* bus_ = nullptr;
+    int span_count_ = 0;
+    double time_ = 0.0;
+};
+
+using RouteItem = std::variant<RouteWait, RouteRide>;
+
+struct RouteInfo {
+    double total_time_ = 0.0;
+    std::vector<RouteItem> items_;
+};
+
+struct ReachableStop {
+    const Stop* stop_ = nullptr;
+    double time_ = 0.0;
+};
+
+struct TravelMatrix {
+    size_t GetRowsCount() const;
+    double GetTime(size_t row, size_t column) const;
+    double GetDistance(size_t row, size_t column) const;
+    bool HasRoute(size_t row, size_t column) const;
+
+    size_t columns_count_ = 0;
+    std::vector<double> times_;
+    std::vector<double> distances_;
+};
+
+class TransportRouter {
+public:
+    TransportRouter(const TransportCatalogue& transport_c, RoutingSettings settings);
+    TransportRouter(const TransportCatalogue& transport_c, RoutingSettings settings, ThreadPool& pool);
+    TransportRouter(const TransportRouter&) = delete;
+    TransportRouter& operator=(const TransportRouter&) = delete;
+
+    std::optional<RouteInfo> BuildRoute(std::string_view from, std::string_view to) const;
+    std::optional<std::vector<ReachableStop>> BuildIsochrone(std::string_view from, double time_limit) const;
+    TravelMatrix BuildMatrix(const std::vector<std::string_view>& origins,
+        const std::vector<std::string_view>& destinations, ThreadPool& pool) const;
+    bool HasStop(std::string_view name) const;
+    const RoutingSettings& GetSettings() const;
+
+    void BuildHierarchy();
+    void SaveHierarchy(std::ostream& out) const;
+    void LoadHierarchy(std::istream& in);
+    bool HasHierarchy() const;
+
+    void BuildLandmarks(size_t landmarks_count, ThreadPool& pool);
+    bool HasLandmarks() const;
+
+private:
+    struct EdgeInfo {
+        const Stop* stop_ = nullptr;
+        const Bus* bus_ = nullptr;
+        int span_count_ = 0;
+        double distance_ = 0.0;
+    };
+
+    void AddWaitEdges(const std::vector<const Stop*>& stops);
+    void AddRideEdges(const Bus& bus);
+    graph::VertexId GetStopVertex(std::string_view name) const;
+    std::vector<graph::VertexId> SelectLandmarks(size_t landmarks_count) const;
+    double ComputeTimeLowerBound(graph::VertexId from, graph::VertexId to) const;
+
+    RoutingSettings settings_;
+    std::unordered_map<std::string_view, graph::VertexId> stops_vertexes_;
+    std::vector<const Stop*> stops_;
+    Geo::DistanceTable stops_distances_;
+    graph::DirectedWeightedGraph<double> graph_;
+    std::vector<EdgeInfo> edges_info_;
+    graph::Router<double> router_;
+    std::unique_ptr<graph::ContractionHierarchy> hierarchy_;
+    std::unique_ptr<graph::LandmarkRouter> landmarks_;
+    double minutes_per_geo_meter_ = 0.0;
+};